@@ -0,0 +1,257 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include "ringbuffer/ring.h"
+#include "ringbuffer/sequence.h"
+#include "ringbuffer/span.h"
+#include "ringbuffer/detail/memory.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace ringbuffer;
+
+namespace {
+
+    // Note: 'wrap-heavy' gulps are 4/3 of the span size, so most gulps cross the end of the
+    //         buffer at some point and need ghost copies, 'aligned' gulps divide the ring size.
+    std::size_t gulp_size(std::size_t span_size, bool wrap) {
+        return wrap ? span_size + span_size / 3 : span_size;
+    }
+
+    std::uint64_t ghost_bytes(const std::shared_ptr<Ring>& ring) {
+        auto stats = ring->stats();
+        return stats.ghost_bytes_written + stats.ghost_bytes_read;
+    }
+
+    void report(benchmark::State& state, const std::shared_ptr<Ring>& ring,
+                std::size_t nspans, std::size_t nbytes, std::uint64_t ghost_bytes_before) {
+        state.SetBytesProcessed(static_cast<int64_t>(nbytes));
+        state.counters["spans"] = benchmark::Counter(static_cast<double>(nspans), benchmark::Counter::kIsRate);
+        state.counters["ghost_bytes"] = benchmark::Counter(
+                static_cast<double>(ghost_bytes(ring) - ghost_bytes_before),
+                benchmark::Counter::kAvgIterations, benchmark::Counter::kIs1024);
+    }
+
+    // Reads spans of nbytes until the sequence ends, skips ahead if the writer overtook the reader
+    void read_until_end(ReadSequence& read_seq, const std::shared_ptr<Ring>& ring, std::size_t nbytes) {
+        std::size_t offset = 0;
+        while( true ) {
+            RBStatus status;
+            ReadSpan read_span(&read_seq, offset, nbytes, false, &status);
+            if( status == RBStatus::STATUS_END_OF_DATA ) {
+                break;
+            }
+            if( status == RBStatus::STATUS_INVALID_SEQUENCE_HANDLE ) {
+                // unguaranteed reader fell behind the tail
+                std::size_t tail = ring->current_tail_offset() - read_seq.begin();
+                offset = (tail + nbytes - 1) / nbytes * nbytes;
+                continue;
+            }
+            if( status == RBStatus::STATUS_SUCCESS && read_span.size() > 0 ) {
+                benchmark::DoNotOptimize(*static_cast<volatile uint8_t*>(read_span.data()));
+            }
+            offset += nbytes;
+        }
+    }
+
+}
+
+// One thread writes and reads each span, measures the pure per-span overhead of the ring
+static void BM_WriteRead(benchmark::State& state) {
+    std::size_t span_size   = static_cast<std::size_t>(state.range(0));
+    std::size_t ring_factor = static_cast<std::size_t>(state.range(1));
+    bool        wrap        = state.range(2) != 0;
+    std::size_t nbytes      = gulp_size(span_size, wrap);
+
+    auto ring = Ring::create("bench_write_read", RBSpace::SPACE_SYSTEM);
+    ring->resize(nbytes, ring_factor * span_size, 1);
+    ring->begin_writing();
+    auto write_seq = std::make_unique<WriteSequence>(ring, "bench", 0, 0, nullptr, 1);
+    auto read_seq  = ReadSequence::by_name_ptr(ring, "bench", true);
+
+    std::uint64_t ghost_before = ghost_bytes(ring);
+    std::size_t n = 0;
+    for (auto _ : state) {
+        {
+            WriteSpan write_span(ring, nbytes, false);
+            std::memset(write_span.data(), int(n), nbytes);
+            write_span.commit(nbytes);
+        }
+        {
+            ReadSpan read_span(read_seq.get(), n * nbytes, nbytes);
+            benchmark::DoNotOptimize(read_span.data());
+        }
+        n++;
+    }
+    report(state, ring, n, n * nbytes, ghost_before);
+
+    read_seq.reset();
+    write_seq.reset();
+    ring->end_writing();
+}
+
+static void WriteReadArguments(benchmark::internal::Benchmark* b) {
+    for (int64_t span_size = 64; span_size <= (16 << 20); span_size *= 16) {
+        for (int64_t ring_factor : {4, 16}) {
+            if (span_size * ring_factor > (256 << 20)) {
+                continue;
+            }
+            for (int64_t wrap : {0, 1}) {
+                b->Args({span_size, ring_factor, wrap});
+            }
+        }
+    }
+    b->Args({16 << 20, 4, 0});
+    b->Args({16 << 20, 4, 1});
+}
+
+BENCHMARK(BM_WriteRead)
+        ->ArgNames({"span", "ring_factor", "wrap"})
+        ->Apply(WriteReadArguments);
+
+
+// The benchmark thread writes, reader threads consume the sequence
+static void BM_Pipeline(benchmark::State& state) {
+    std::size_t span_size   = static_cast<std::size_t>(state.range(0));
+    std::size_t nreaders    = static_cast<std::size_t>(state.range(1));
+    bool        guaranteed  = state.range(2) != 0;
+    bool        nonblocking = state.range(3) != 0;
+    bool        wrap        = state.range(4) != 0;
+    std::size_t nbytes      = gulp_size(span_size, wrap);
+
+    auto ring = Ring::create("bench_pipeline", RBSpace::SPACE_SYSTEM);
+    ring->resize(nbytes, 8 * span_size, 1);
+    ring->begin_writing();
+
+    std::uint64_t would_block = 0;
+    std::size_t n = 0;
+    std::uint64_t ghost_before = ghost_bytes(ring);
+    {
+        WriteSequence write_seq(ring, "bench", 0, 0, nullptr, 1);
+
+        std::atomic<std::size_t> readers_ready{0};
+        std::vector<std::thread> readers;
+        for (std::size_t r = 0; r < nreaders; r++) {
+            readers.emplace_back([&]() {
+                auto read_seq = ReadSequence::by_name(ring, "bench", guaranteed);
+                ++readers_ready;
+                read_until_end(read_seq, ring, nbytes);
+            });
+        }
+        while (readers_ready != nreaders) {
+            std::this_thread::yield();
+        }
+
+        for (auto _ : state) {
+            if (nonblocking) {
+                RBStatus status;
+                while (true) {
+                    WriteSpan write_span(ring, nbytes, true, &status);
+                    if (status == RBStatus::STATUS_SUCCESS) {
+                        std::memset(write_span.data(), int(n), nbytes);
+                        write_span.commit(nbytes);
+                        break;
+                    }
+                    would_block++;
+                    std::this_thread::yield();
+                }
+            } else {
+                WriteSpan write_span(ring, nbytes, false);
+                std::memset(write_span.data(), int(n), nbytes);
+                write_span.commit(nbytes);
+            }
+            n++;
+        }
+
+        write_seq.finish();
+        for (auto& reader : readers) {
+            reader.join();
+        }
+    }
+    ring->end_writing();
+
+    report(state, ring, n, n * nbytes, ghost_before);
+    state.counters["would_block"] = benchmark::Counter(static_cast<double>(would_block), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_Pipeline)
+        ->ArgNames({"span", "readers", "guaranteed", "nonblocking", "wrap"})
+        ->ArgsProduct({{64, 4 << 10, 256 << 10, 4 << 20}, {1, 4}, {0, 1}, {0, 1}, {0, 1}})
+        ->UseRealTime();
+
+// Copies between two buffers larger than the last level cache, as in ring migration
+//   or forwarding between rings, with regular or streaming stores split across threads
+static void BM_Memcpy2D(benchmark::State& state) {
+    std::size_t width       = static_cast<std::size_t>(state.range(0));
+    std::size_t height      = static_cast<std::size_t>(state.range(1));
+    bool        nontemporal = state.range(2) != 0;
+    std::size_t nthread     = static_cast<std::size_t>(state.range(3));
+    std::size_t stride      = width + memory::getAlignment();
+
+    std::vector<uint8_t> src(stride * height, 1), dst(stride * height, 0);
+    for (auto _ : state) {
+        if (nthread > 1) {
+            memory::memcpy2DParallel(dst.data(), stride, src.data(), stride, width, height,
+                                     nthread, nullptr, nontemporal);
+        } else if (nontemporal) {
+            memory::memcpy2DNonTemporal(dst.data(), stride, src.data(), stride, width, height);
+        } else {
+            memory::memcpy2D(dst.data(), stride, RBSpace::SPACE_SYSTEM,
+                             src.data(), stride, RBSpace::SPACE_SYSTEM, width, height);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * width * height));
+}
+
+BENCHMARK(BM_Memcpy2D)
+        ->ArgNames({"width", "height", "nontemporal", "threads"})
+        ->ArgsProduct({{64 << 10, 16 << 20}, {1, 4}, {0, 1}, {1, 4}})
+        ->UseRealTime();
+
+BENCHMARK_MAIN();
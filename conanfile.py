@@ -25,10 +25,13 @@ class RingbufferConan(ConanFile):
         "with_cuda": [True, False],
         "with_omp": [True, False],
         "with_numa": [True, False],
+        "with_hwloc": [True, False],
+        "with_usdt": [True, False],
         "with_nvtoolsext": [True, False],
         "enable_fibers": [True, False],
         "enable_debug": [True, False],
         "enable_trace": [True, False],
+        "with_benchmarks": [True, False],
     }
 
     requires = (
@@ -42,14 +45,17 @@ class RingbufferConan(ConanFile):
         "with_cuda": False,
         "with_omp": False,
         "with_numa": False,
+        "with_hwloc": False,
+        "with_usdt": False,
         "with_nvtoolsext": False,
         "enable_fibers": False,
         "enable_debug": False,
         "enable_trace": False,
+        "with_benchmarks": False,
     }
 
     # all sources are deployed with the package
-    exports_sources = "modules/*", "include/*", "src/*", "tests/*", "CMakeLists.txt"
+    exports_sources = "modules/*", "include/*", "src/*", "tests/*", "benchmarks/*", "CMakeLists.txt"
 
     def requirements(self):
         if self.options.with_cuda:
@@ -58,6 +64,9 @@ class RingbufferConan(ConanFile):
         if self.options.enable_fibers:
             self.requires("fiberpool/0.1@camposs/stable")
 
+        if self.options.with_benchmarks:
+            self.requires("benchmark/1.6.1")
+
 
     def system_requirements(self):
         if tools.os_info.is_linux:
@@ -65,9 +74,15 @@ class RingbufferConan(ConanFile):
             if self.options.with_numa:
                 pack_names.append("libnuma-dev")
 
+            if self.options.with_hwloc:
+                pack_names.append("libhwloc-dev")
+
             if self.options.with_omp:
                 pack_names.append("libomp-dev")
 
+            if self.options.with_usdt:
+                pack_names.append("systemtap-sdt-dev")
+
             installer = tools.SystemPackageTool()
             for p in pack_names:
                 installer.install(p)
@@ -105,6 +105,44 @@ namespace ringbuffer {
     std::string RINGBUFFER_EXPORT getSpaceString(RBSpace space);
 
 
+    /*
+     * Enum to select how a ring waits for space, data or sequences
+     */
+    enum class RBWaitPolicy {
+        WAIT_BLOCK         = 0, // sleep on the condition variable
+        WAIT_SPIN          = 1, // busy-spin with a pause instruction, never sleeps
+        WAIT_SPIN_YIELD    = 2, // spin for spin_count iterations, then yield the thread/fiber
+        WAIT_ADAPTIVE      = 3  // spin for spin_count iterations, then sleep on the condition variable
+    };
+
+    std::string RINGBUFFER_EXPORT getWaitPolicyString(RBWaitPolicy policy);
+
+    /*
+     * Pages backing the buffer of SPACE_SYSTEM rings, see Ring::set_hugepages
+     */
+    enum class RBHugePages {
+        HUGEPAGES_NONE        = 0, // posix_memalign with RINGBUFFER_ALIGNMENT
+        HUGEPAGES_TRANSPARENT = 1, // anonymous mapping with madvise(MADV_HUGEPAGE)
+        HUGEPAGES_2MB         = 2, // explicit huge pages (MAP_HUGETLB), falls back to transparent ones
+        HUGEPAGES_1GB         = 3  // explicit huge pages (MAP_HUGETLB), falls back to 2MB, then transparent ones
+    };
+
+    std::string RINGBUFFER_EXPORT getHugePagesString(RBHugePages pages);
+
+    /*
+     * NUMA placement of the ring buffer, see Ring::set_numa_policy (requires RINGBUFFER_WITH_NUMA)
+     */
+    enum class RBNumaPolicy {
+        NUMA_NONE       = 0, // first-touch placement by the kernel
+        NUMA_CORE       = 1, // bind to the node of the ring's core, if set
+        NUMA_NODE       = 2, // bind to an explicit node
+        NUMA_INTERLEAVE = 3, // interleave pages across the given (or all) nodes
+        NUMA_RINGLETS   = 4  // bind ringlet i to node i modulo the given (or all) nodes
+    };
+
+    std::string RINGBUFFER_EXPORT getNumaPolicyString(RBNumaPolicy policy);
+
+
     /*
      * Helpers for checking if features are enabled
      */
@@ -112,6 +150,9 @@ namespace ringbuffer {
     RBStatus RINGBUFFER_EXPORT setDebugEnabled(bool enabled);
     bool RINGBUFFER_EXPORT getCudaEnabled();
     bool RINGBUFFER_EXPORT getShmEnabled();
+    // ProcLog files for rings created afterwards, on by default unless RINGBUFFER_PROCLOG=0
+    bool RINGBUFFER_EXPORT getProcLogEnabled();
+    RBStatus RINGBUFFER_EXPORT setProcLogEnabled(bool enabled);
 
     /*
      * Ringbuffer Exception Class
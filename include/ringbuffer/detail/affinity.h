@@ -47,6 +47,8 @@
 #include "ringbuffer/common.h"
 #include "ringbuffer/visibility.h"
 
+#include <vector>
+
 namespace ringbuffer{
     namespace affinity {
 
@@ -56,6 +58,33 @@ namespace ringbuffer{
         RBStatus RINGBUFFER_EXPORT affinityGetCore(int* core);
 
         RBStatus RINGBUFFER_EXPORT affinitySetOpenMPCores(std::size_t nthread, const int* thread_cores);
+
+        // Note: Cores are OS cpu indices as for affinitySetCore. Pass an empty set to unbind
+        RBStatus RINGBUFFER_EXPORT affinitySetCores(const std::vector<int>& cores);
+
+        RBStatus RINGBUFFER_EXPORT affinityGetCores(std::vector<int>* cores);
+
+        // pin the calling thread to all cores of a NUMA node
+        RBStatus RINGBUFFER_EXPORT affinitySetNumaNode(int node);
+
+        // pin the calling thread to the cores that share the cache of the given level with core
+        //   (the L3 domain or CCX for level 3)
+        RBStatus RINGBUFFER_EXPORT affinitySetCacheDomain(int core, int level=3);
+
+        /*
+         * Topology queries, from hwloc with RINGBUFFER_WITH_HWLOC and from sysfs otherwise (Linux only)
+         */
+        RBStatus RINGBUFFER_EXPORT topologyGetNumaNodeCores(int node, std::vector<int>* cores);
+
+        // cores sharing the (data or unified) cache of the given level with core, including core
+        RBStatus RINGBUFFER_EXPORT topologyGetCacheCores(int core, int level, std::vector<int>* cores);
+
+        // all distinct core sets that share a cache of the given level
+        RBStatus RINGBUFFER_EXPORT topologyGetCacheDomains(int level, std::vector<std::vector<int>>* domains);
+
+        // ncore cores that share the cache of the given level with core, starting with core,
+        //   e.g. to place a writer and its readers. Cores are reused if the domain is smaller.
+        RBStatus RINGBUFFER_EXPORT topologyPlaceOnCache(int core, int level, std::size_t ncore, std::vector<int>* cores);
     }
 }
 
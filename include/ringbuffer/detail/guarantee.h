@@ -56,6 +56,7 @@ namespace ringbuffer {
         class RINGBUFFER_EXPORT Guarantee {
             std::shared_ptr<Ring> m_ring;
             std::size_t m_offset;
+            int m_slot;
 
             void create(std::size_t offset);
             void destroy();
@@ -0,0 +1,99 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#ifndef RINGBUFFER_GUARANTEE_TABLE_H
+#define RINGBUFFER_GUARANTEE_TABLE_H
+
+#include "ringbuffer/common.h"
+#include "ringbuffer/visibility.h"
+#include "ringbuffer/types.h"
+
+#include <atomic>
+
+#ifndef RINGBUFFER_MAX_GUARANTEES
+    #define RINGBUFFER_MAX_GUARANTEES 64
+#endif
+
+namespace ringbuffer {
+    namespace state {
+
+        // Fixed table of per-reader guarantee cursors.
+        //
+        // Moving a cursor forward is a single atomic store. The writer checks the
+        //   cached 'earliest' offset, which is only ever a lower bound of all active
+        //   cursors, and recomputes it by scanning the table when the bound is too old.
+        // Note: add, remove, move_back and recompute_earliest must be serialized by
+        //         the caller, move_forward and the queries are lock-free.
+        // Note: The table contains only atomics and plain integers so that it can
+        //         live in shared memory.
+        struct RINGBUFFER_EXPORT GuaranteeTable {
+            struct alignas(RINGBUFFER_CACHE_LINE_SIZE) Slot {
+                std::atomic<std::size_t> offset{0};
+                std::atomic<bool>        active{false};
+            };
+
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> count{0};
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> earliest{0};
+            Slot slots[RINGBUFFER_MAX_GUARANTEES];
+
+            // returns the slot index, or -1 if the table is full
+            int  add(std::size_t offset);
+            void remove(int slot);
+            void move_back(int slot, std::size_t offset);
+            std::size_t recompute_earliest(std::size_t reference);
+
+            inline void move_forward(int slot, std::size_t offset) {
+                slots[slot].offset.store(offset);
+            }
+            inline std::size_t offset(int slot) const { return slots[slot].offset.load(); }
+            inline bool        empty()          const { return count.load() == 0; }
+            inline std::size_t earliest_bound() const { return earliest.load(); }
+
+        private:
+            void _lower_earliest(std::size_t offset);
+        };
+
+    }
+}
+
+#endif //RINGBUFFER_GUARANTEE_TABLE_H
@@ -0,0 +1,126 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#ifndef RINGBUFFER_HISTOGRAM_H
+#define RINGBUFFER_HISTOGRAM_H
+
+#include "ringbuffer/common.h"
+#include "ringbuffer/visibility.h"
+#include "ringbuffer/types.h"
+#include "ringbuffer/ring_stats.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef RINGBUFFER_HISTOGRAM_SHARDS
+    #define RINGBUFFER_HISTOGRAM_SHARDS 8
+#endif
+#ifndef RINGBUFFER_COMMIT_TIMES
+    #define RINGBUFFER_COMMIT_TIMES 256
+#endif
+
+namespace ringbuffer {
+    namespace state {
+
+        // Log-bucketed latency histogram (HDR style) in nanoseconds.
+        //
+        // Each power of two is split into 8 linear sub-buckets, so a value is known to
+        //   within 12.5%. Threads record into one of a few shards (picked once per thread)
+        //   with relaxed atomic adds, the shards are merged when the histogram is read.
+        class RINGBUFFER_EXPORT LatencyHistogram {
+        public:
+            static constexpr int SUB_BUCKET_BITS = 3;
+            static constexpr int SUB_BUCKETS     = 1 << SUB_BUCKET_BITS;
+            static constexpr int BUCKETS         = 64 * SUB_BUCKETS;
+
+            void record(std::uint64_t ns);
+            inline void record(std::chrono::nanoseconds duration) {
+                this->record(std::uint64_t(std::max(duration.count(), decltype(duration.count())(0))));
+            }
+            LatencySummary summary() const;
+
+            static int bucket_of(std::uint64_t ns);
+            // largest value that falls into bucket
+            static std::uint64_t bucket_upper(int bucket);
+
+        private:
+            struct alignas(RINGBUFFER_CACHE_LINE_SIZE) Shard {
+                std::atomic<std::uint64_t> max{0};
+                std::atomic<std::uint64_t> buckets[BUCKETS]{};
+            };
+            Shard m_shards[RINGBUFFER_HISTOGRAM_SHARDS];
+        };
+
+        // Commit timestamps of the most recent commits, used to measure the delay
+        //   between committing data and a reader acquiring it.
+        // Note: Written by the committing thread only (commits are ordered), read lock-free.
+        //         Entries that are overwritten while a reader looks at them are detected
+        //         by re-reading the end offset.
+        class RINGBUFFER_EXPORT CommitTimes {
+        public:
+            void record(std::size_t end, std::chrono::steady_clock::time_point time);
+            // commit time of the data up to end, false if it is not known (anymore)
+            bool lookup(std::size_t end, std::chrono::steady_clock::time_point* time) const;
+
+        private:
+            struct Entry {
+                std::atomic<std::size_t>  end{0};
+                std::atomic<std::int64_t> time{0};
+            };
+            std::atomic<std::uint64_t> m_count{0};
+            Entry m_entries[RINGBUFFER_COMMIT_TIMES];
+        };
+
+        struct RINGBUFFER_EXPORT RingHistograms {
+            LatencyHistogram reserve_wait;
+            LatencyHistogram commit_wait;
+            LatencyHistogram acquire_wait;
+            LatencyHistogram commit_to_acquire;
+            CommitTimes      commit_times;
+        };
+
+    }
+}
+
+#endif //RINGBUFFER_HISTOGRAM_H
@@ -52,6 +52,21 @@
     #define RINGBUFFER_ALIGNMENT 512
 #endif
 
+#ifndef RINGBUFFER_NONTEMPORAL_THRESHOLD
+    // copies below this size are expected to fit the last level cache
+    #define RINGBUFFER_NONTEMPORAL_THRESHOLD (1 << 20)
+#endif
+
+#ifndef RINGBUFFER_PARALLEL_COPY_THRESHOLD
+    // copies, sets and prefaults below this size stay on one thread, see memcpy2DParallel
+    #define RINGBUFFER_PARALLEL_COPY_THRESHOLD (4 << 20)
+#endif
+
+#ifndef RINGBUFFER_MIGRATE_CHUNK_SIZE
+    // default number of bytes Ring::migrate_to_node moves between progress reports
+    #define RINGBUFFER_MIGRATE_CHUNK_SIZE (16 << 20)
+#endif
+
 
 namespace ringbuffer {
     namespace memory {
@@ -93,6 +108,19 @@ namespace ringbuffer {
                           std::size_t width,
                           std::size_t height);
 
+        /*
+         * copy 2D array within system memory with streaming stores that bypass the caches
+         * (AVX-512, AVX2 or SSE2, selected at runtime), for large copies whose destination is
+         * not read again soon, e.g. ring migration or forwarding between rings.
+         * Copies below RINGBUFFER_NONTEMPORAL_THRESHOLD bytes use memcpy2D.
+         */
+        RBStatus RINGBUFFER_EXPORT memcpy2DNonTemporal(void*       dst,
+                                                       std::size_t dst_stride,
+                                                       const void* src,
+                                                       std::size_t src_stride,
+                                                       std::size_t width,
+                                                       std::size_t height);
+
         /*
          * set memory to given value
          * Note: only works for byte types
@@ -118,6 +146,134 @@ namespace ringbuffer {
          */
         std::size_t RINGBUFFER_EXPORT getAlignment();
 
+        /*
+         * get size of a (small) page of virtual memory
+         */
+        std::size_t RINGBUFFER_EXPORT getPageSize();
+
+        /*
+         * allocate nmirror regions of size bytes in system memory, each of which is
+         * mapped twice back-to-back, i.e. region i occupies [ptr+2*i*size, ptr+2*(i+1)*size)
+         * and its second half shows the same physical pages as its first half
+         * Note: size must be a multiple of the page size
+         */
+        RBStatus RINGBUFFER_EXPORT mallocMirrored(void** ptr, std::size_t size, std::size_t nmirror);
+
+        /*
+         * map nmirror regions of size bytes of the file fd, starting at offset, twice
+         * back-to-back each (same layout as mallocMirrored), free with freeMirrored
+         */
+        RBStatus RINGBUFFER_EXPORT mapMirrored(void** ptr, int fd, std::size_t offset, std::size_t size, std::size_t nmirror);
+
+        /*
+         * free memory allocated with mallocMirrored
+         */
+        RBStatus RINGBUFFER_EXPORT freeMirrored(void* ptr, std::size_t size, std::size_t nmirror);
+
+        /*
+         * get size of the pages used for the given huge page mode (getPageSize() for HUGEPAGES_NONE)
+         */
+        std::size_t RINGBUFFER_EXPORT getHugePageSize(RBHugePages pages);
+
+        /*
+         * allocate size bytes of system memory backed by huge pages, aligned to the huge page size.
+         * Explicit huge pages fall back to transparent ones if the pool is exhausted,
+         * used (optional) returns the mode that was actually used.
+         * Note: Free with freeHuge and the same size and used mode
+         */
+        RBStatus RINGBUFFER_EXPORT mallocHuge(void** ptr, std::size_t size, RBHugePages pages, RBHugePages* used);
+
+        RBStatus RINGBUFFER_EXPORT freeHuge(void* ptr, std::size_t size, RBHugePages used);
+
+        /*
+         * huge page mode of newly created SPACE_SYSTEM rings (default HUGEPAGES_NONE)
+         */
+        void RINGBUFFER_EXPORT setDefaultHugePages(RBHugePages pages);
+        RBHugePages RINGBUFFER_EXPORT getDefaultHugePages();
+
+        /*
+         * fault in size bytes of system memory by writing zeros to every page,
+         * from a thread pinned to core (first-touch placement) unless core is -1
+         */
+        RBStatus RINGBUFFER_EXPORT prefault(void* ptr, std::size_t size, int core);
+
+        /*
+         * prefault split into page aligned chunks across nthread pooled threads (see
+         * memcpy2DParallel), thread t is pinned to thread_cores[t] (thread_cores may be null,
+         * -1 does not pin). The calling thread only waits, so every page is placed by a pinned thread.
+         * Below RINGBUFFER_PARALLEL_COPY_THRESHOLD only thread_cores[0] is used.
+         */
+        RBStatus RINGBUFFER_EXPORT prefaultParallel(void* ptr, std::size_t size,
+                                                    std::size_t nthread, const int* thread_cores);
+
+        /*
+         * copy 2D array within system memory in nthread parts, rows are split if there are
+         * enough of them, page aligned columns otherwise. Part t runs on a pooled thread pinned
+         * to thread_cores[t] (thread_cores may be null, -1 does not pin), the last part on the
+         * calling thread. The pooled threads are kept per core list, while they are busy with
+         * another call the calling thread does all parts. Copies below
+         * RINGBUFFER_PARALLEL_COPY_THRESHOLD are done by the calling thread alone.
+         * nontemporal copies as memcpy2DNonTemporal
+         */
+        RBStatus RINGBUFFER_EXPORT memcpy2DParallel(void*       dst,
+                                                    std::size_t dst_stride,
+                                                    const void* src,
+                                                    std::size_t src_stride,
+                                                    std::size_t width,
+                                                    std::size_t height,
+                                                    std::size_t nthread,
+                                                    const int*  thread_cores,
+                                                    bool        nontemporal=false);
+
+        /*
+         * set 2D array within system memory in nthread parts as for memcpy2DParallel
+         */
+        RBStatus RINGBUFFER_EXPORT memset2DParallel(void*       ptr,
+                                                    std::size_t stride,
+                                                    int         value,
+                                                    std::size_t width,
+                                                    std::size_t height,
+                                                    std::size_t nthread,
+                                                    const int*  thread_cores);
+
+        /*
+         * lock size bytes of system memory into RAM (mlock), unlock before freeing
+         * Note: fails with STATUS_MEM_OP_FAILED if RLIMIT_MEMLOCK is exceeded
+         */
+        RBStatus RINGBUFFER_EXPORT lockMemory(void* ptr, std::size_t size);
+
+        RBStatus RINGBUFFER_EXPORT unlockMemory(void* ptr, std::size_t size);
+
+        /*
+         * give the whole pages (of page_size bytes) within [ptr, ptr+size) of system memory back
+         * to the kernel, they read as zero when touched again. shared selects MADV_REMOVE for
+         * shared mappings (e.g. mirrored memory), whose pages MADV_DONTNEED would not free.
+         * Note: fails with STATUS_MEM_OP_FAILED for locked memory
+         */
+        RBStatus RINGBUFFER_EXPORT discardMemory(void* ptr, std::size_t size, std::size_t page_size, bool shared);
+
+        /*
+         * number of bytes of the pages covering [ptr, ptr+size) that are resident in RAM (mincore)
+         */
+        RBStatus RINGBUFFER_EXPORT getResidentSize(const void* ptr, std::size_t size, std::size_t* nresident);
+
+        /*
+         * NUMA topology and placement of system memory, STATUS_UNSUPPORTED without RINGBUFFER_WITH_NUMA
+         * or if the system has no NUMA support.
+         * Note: Placement applies to whole pages, the range is extended to page boundaries.
+         *         Pages already faulted in elsewhere are moved.
+         */
+        RBStatus RINGBUFFER_EXPORT getNumaNodeCount(int* count);
+        RBStatus RINGBUFFER_EXPORT getNumaNodeOfCore(int core, int* node);
+        // node the page at ptr resides on, faults the page in if necessary
+        RBStatus RINGBUFFER_EXPORT getNumaNodeOfAddress(const void* ptr, int* node);
+        RBStatus RINGBUFFER_EXPORT bindToNumaNode(void* ptr, std::size_t size, int node);
+        // nodes may be null to interleave across all nodes
+        RBStatus RINGBUFFER_EXPORT interleaveNumaNodes(void* ptr, std::size_t size, const int* nodes, std::size_t nnode);
+        // binds [ptr, ptr+size) to node like bindToNumaNode, nmoved (optional) returns the number of bytes
+        //   that were faulted in on other nodes and now reside on node
+        RBStatus RINGBUFFER_EXPORT migrateToNumaNode(void* ptr, std::size_t size, int node, std::size_t* nmoved);
+
     }
 }
 
@@ -0,0 +1,85 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#ifndef RINGBUFFER_PROBES_H
+#define RINGBUFFER_PROBES_H
+
+#include "ringbuffer/config.h"
+
+/*
+ * USDT (statically defined tracing) probes in the ring hot paths, provider "ringbuffer".
+ *
+ * Compiled in with WITH_USDT (needs sys/sdt.h from systemtap-sdt-dev). An unattached probe
+ *   is a single nop, so the probes can stay enabled in production builds. List them with
+ *   `bpftrace -l 'usdt:/path/to/libringbuffer.so:ringbuffer:*'` or `perf list sdt_ringbuffer:*`.
+ *   The first argument of every probe is the ring name (a C string).
+ *
+ * Probes (after the ring name):
+ *   reserve_span_entry     size
+ *   reserve_span_return    size, begin, status
+ *   reserve_wait_start     size, reserve_head
+ *   reserve_wait_end       size, status, waited_ns
+ *   commit_span            begin, reserve_size, commit_size
+ *   acquire_span_entry     offset (relative to the sequence), requested_size
+ *   acquire_span_return    begin, size, status
+ *   release_span           begin, size
+ *   tail_pull              old_tail, new_tail
+ *   sequence_discard       sequence end, time_tag
+ *   ghost_write            buf_offset, size (bytes copied per ringlet)
+ *   ghost_read             buf_offset, size
+ *   resize                 ghost_span, span, nringlet (after the reallocation)
+ */
+#ifdef RINGBUFFER_WITH_USDT
+#include <sys/sdt.h>
+#define RB_PROBE1(name, a1)                         DTRACE_PROBE1(ringbuffer, name, a1)
+#define RB_PROBE2(name, a1, a2)                     DTRACE_PROBE2(ringbuffer, name, a1, a2)
+#define RB_PROBE3(name, a1, a2, a3)                 DTRACE_PROBE3(ringbuffer, name, a1, a2, a3)
+#define RB_PROBE4(name, a1, a2, a3, a4)             DTRACE_PROBE4(ringbuffer, name, a1, a2, a3, a4)
+#else // not RINGBUFFER_WITH_USDT
+#define RB_PROBE1(name, a1)
+#define RB_PROBE2(name, a1, a2)
+#define RB_PROBE3(name, a1, a2, a3)
+#define RB_PROBE4(name, a1, a2, a3, a4)
+#endif // RINGBUFFER_WITH_USDT
+
+#endif //RINGBUFFER_PROBES_H
@@ -0,0 +1,120 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#ifndef RINGBUFFER_PROCLOG_H
+#define RINGBUFFER_PROCLOG_H
+
+#pragma warning( disable : 4251 ) // needs to have dll-interface to be used by clients of class
+
+#include "ringbuffer/common.h"
+#include "ringbuffer/visibility.h"
+#include "ringbuffer/types.h"
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#ifndef RINGBUFFER_PROCLOG_DIR
+    #define RINGBUFFER_PROCLOG_DIR "/dev/shm/ringbuffer"
+#endif
+#ifndef RINGBUFFER_PROCLOG_INTERVAL_MS
+    #define RINGBUFFER_PROCLOG_INTERVAL_MS 1000
+#endif
+
+namespace ringbuffer {
+    namespace proclog {
+
+        /*
+         * Per-process directory of the ProcLog files: $RINGBUFFER_PROCLOG_DIR/<pid>
+         *   (RINGBUFFER_PROCLOG_DIR defaults to /dev/shm/ringbuffer, any tmpfs dir works).
+         */
+        std::string RINGBUFFER_EXPORT directory();
+
+        /*
+         * how often the monitor thread rewrites all ProcLog files
+         */
+        void RINGBUFFER_EXPORT setUpdateInterval(std::chrono::milliseconds interval);
+        std::chrono::milliseconds RINGBUFFER_EXPORT getUpdateInterval();
+
+        /*
+         * A small text file (<directory>/<block>/<name>) of "key : value" lines that
+         *   describes a live object, so that it can be inspected from outside the process.
+         *
+         * The contents are the static part (set_static, e.g. the geometry of a ring) followed
+         *   by the output of source, which is called from a process-wide monitor thread every
+         *   update interval. The file is removed again when the ProcLog is destroyed.
+         * Note: source must not take locks that are held while the ProcLog is destroyed,
+         *         the destructor waits for a running update.
+         */
+        class RINGBUFFER_EXPORT ProcLog {
+        public:
+            using source_type = std::function<std::string()>;
+
+            ProcLog(const std::string& block, const std::string& name, source_type source);
+            ~ProcLog();
+
+            ProcLog(const ProcLog&) = delete;
+            ProcLog& operator=(const ProcLog&) = delete;
+
+            void set_static(std::string contents);
+            // rewrite the file now instead of waiting for the monitor thread
+            void update();
+
+            inline const std::string& path() const { return m_path; }
+
+        private:
+            // empty if the file could not be created, updates are skipped then
+            std::string m_path;
+            source_type m_source;
+            // process that created the file, a forked child must not remove it
+            long        m_pid{0};
+
+            std::mutex  m_mutex;
+            std::string m_static;
+        };
+
+    }
+}
+
+#endif //RINGBUFFER_PROCLOG_H
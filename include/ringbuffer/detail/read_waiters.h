@@ -0,0 +1,86 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#ifndef RINGBUFFER_READ_WAITERS_H
+#define RINGBUFFER_READ_WAITERS_H
+
+#include "ringbuffer/common.h"
+#include "ringbuffer/visibility.h"
+#include "ringbuffer/types.h"
+
+#include <vector>
+
+namespace ringbuffer {
+    namespace state {
+
+        // Readers blocked in acquire_span, each with the offset up to which it needs data.
+        //
+        // Every reader sleeps on its own condition, so a commit only wakes the readers
+        //   whose requested span became complete instead of all of them.
+        // Note: All methods must be called with the ring mutex held.
+        // Note: The list is scanned linearly, it holds at most one entry per blocked reader
+        //         and offsets wrap, so a sorted container would not pay off.
+        class RINGBUFFER_EXPORT ReadWaiters {
+        public:
+            struct Waiter {
+                explicit Waiter(std::size_t end_) : end(end_) {}
+                std::size_t    end;
+                condition_type condition;
+            };
+
+            void add(Waiter* waiter);
+            void remove(Waiter* waiter);
+            // wakes the waiters whose end is not beyond head
+            void notify_until(std::size_t head);
+            // wakes all waiters, e.g. when a sequence ended or a reallocation finished
+            void notify_all();
+            inline bool empty() const { return m_waiters.empty(); }
+
+        private:
+            std::vector<Waiter*> m_waiters;
+        };
+
+    }
+}
+
+#endif //RINGBUFFER_READ_WAITERS_H
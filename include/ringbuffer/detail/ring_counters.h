@@ -0,0 +1,96 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#ifndef RINGBUFFER_RING_COUNTERS_H
+#define RINGBUFFER_RING_COUNTERS_H
+
+#include "ringbuffer/common.h"
+#include "ringbuffer/visibility.h"
+#include "ringbuffer/types.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace ringbuffer {
+    namespace state {
+
+        // Counters behind Ring::stats().
+        //
+        // All updates are relaxed atomic adds so they can stay enabled in production,
+        //   writer and reader counters live on separate cache lines.
+        struct RINGBUFFER_EXPORT RingCounters {
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::uint64_t> bytes_committed{0};
+            std::atomic<std::uint64_t> spans_committed{0};
+            std::atomic<std::uint64_t> ghost_bytes_written{0};
+            std::atomic<std::uint64_t> write_waits{0};
+            std::atomic<std::uint64_t> write_wait_ns{0};
+            std::atomic<std::uint64_t> reallocs{0};
+
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::uint64_t> bytes_acquired{0};
+            std::atomic<std::uint64_t> spans_acquired{0};
+            std::atomic<std::uint64_t> bytes_overwritten{0};
+            std::atomic<std::uint64_t> ghost_bytes_read{0};
+            std::atomic<std::uint64_t> read_waits{0};
+            std::atomic<std::uint64_t> read_wait_ns{0};
+
+            static inline void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+                counter.fetch_add(value, std::memory_order_relaxed);
+            }
+            static inline std::uint64_t get(const std::atomic<std::uint64_t>& counter) {
+                return counter.load(std::memory_order_relaxed);
+            }
+            // returns the duration of the wait
+            static inline std::chrono::nanoseconds add_wait(std::atomic<std::uint64_t>& count, std::atomic<std::uint64_t>& time_ns,
+                                                            std::chrono::steady_clock::time_point since) {
+                auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since);
+                add(count, 1);
+                add(time_ns, std::uint64_t(duration.count()));
+                return duration;
+            }
+        };
+
+    }
+}
+
+#endif //RINGBUFFER_RING_COUNTERS_H
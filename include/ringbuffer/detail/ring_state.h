@@ -49,17 +49,41 @@
 #include "ringbuffer/common.h"
 #include "ringbuffer/visibility.h"
 #include "ringbuffer/types.h"
+#include "ringbuffer/detail/guarantee_table.h"
+#include "ringbuffer/detail/shm.h"
+#include "ringbuffer/detail/wait.h"
+#include "ringbuffer/detail/read_waiters.h"
+#include "ringbuffer/detail/ring_counters.h"
+#include "ringbuffer/detail/histogram.h"
+#include "ringbuffer/detail/proclog.h"
 
 #include <string>
 #include <queue>
 #include <set>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 
 namespace ringbuffer {
 
 
     namespace state {
+        // geometry and backing of a buffer allocation, see Ring::resize
+        struct RINGBUFFER_EXPORT BufferInfo {
+            pointer          buf{nullptr};
+            std::size_t      ghost_span{0};
+            std::size_t      span{0};
+            std::size_t      stride{0};
+            std::size_t      nringlet{0};
+            std::size_t      offset0{0};
+            RBHugePages      hugepages{RBHugePages::HUGEPAGES_NONE};
+            bool             memlocked{false};
+            std::vector<int> numa_nodes;
+        };
+
         // RingState is factored out of the class to allow shm allocation later
 
         struct RINGBUFFER_EXPORT RingState {
@@ -74,26 +98,99 @@ namespace ringbuffer {
             std::size_t nringlet{0};
             std::size_t offset0{0};
 
-            std::size_t tail{0};
-            std::size_t head{0};
-            std::size_t reserve_head{0};
+            // Note: tail, head and reserve_head are atomics on their own cache lines
+            //         so that the spsc fast path can read them without the mutex.
+            //         All other accesses still happen under the mutex.
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> tail{0};
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> head{0};
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> reserve_head{0};
 
-            std::size_t ghost_dirty_beg{0};
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::size_t ghost_dirty_beg{0};
 
             bool writing_begun{false};
             bool writing_ended{false};
             std::size_t eod{0};
 
             mutable mutex_type mutex;
-            condition_type read_condition;
+            ReadWaiters    read_waiters;
             condition_type write_condition;
             condition_type write_close_condition;
             condition_type realloc_condition;
             mutable condition_type sequence_condition;
 
-            std::size_t nread_open{0};
-            std::size_t nwrite_open{0};
-            std::size_t nrealloc_pending{0};
+            std::atomic<std::size_t> nread_open{0};
+            std::atomic<std::size_t> nwrite_open{0};
+            std::atomic<std::size_t> nrealloc_pending{0};
+
+            // single-producer/single-consumer mode: spans are reserved, committed,
+            //   acquired and released without taking the mutex when no side has to wait
+            bool spsc{false};
+            // mirrored storage: each ringlet is mapped twice back-to-back in virtual memory,
+            //   so spans that wrap are contiguous without any ghost-region copies
+            bool mirrored{false};
+            // huge pages requested for the buffer (see Ring::set_hugepages) and backing the current one
+            RBHugePages hugepages{RBHugePages::HUGEPAGES_NONE};
+            RBHugePages buf_hugepages{RBHugePages::HUGEPAGES_NONE};
+            // fault in / mlock new buffers at resize (see Ring::set_prefault, Ring::set_memlock)
+            bool prefault{false};
+            bool memlock{false};
+            bool buf_memlocked{false};
+            // worker threads for prefaulting and migrating at resize (see Ring::set_resize_threads)
+            std::size_t resize_nthread{1};
+            std::vector<int> resize_cores;
+            // NUMA placement (see Ring::set_numa_policy) and the node of every ringlet of the current buffer
+            RBNumaPolicy numa_policy{RBNumaPolicy::NUMA_CORE};
+            std::vector<int> numa_nodes;
+            std::vector<int> buf_numa_nodes;
+            // set while Ring::migrate_to_node moves the pages of buf or an incremental resize still
+            //   holds the previous buffer, resize waits for it on realloc_condition
+            bool migrating{false};
+            // incremental resize (see Ring::set_incremental_resize): old_buffer stays alive until the
+            //   old_nopen spans that were open at the switch are closed and [tail, old_head) has been
+            //   copied by migrate_thread. Write spans reserved before old_reserve_head still write into
+            //   old_buffer and copy their data over when they are committed. The chunk
+            //   [migrate_copied, migrate_copy_end) is being copied, everything before it is done.
+            //   late_reservations are reservations before old_reserve_head that waited for space
+            //   across the switch and so were placed in the new buffer.
+            bool          incremental_resize{false};
+            BufferInfo    old_buffer;
+            std::size_t   old_nopen{0};
+            std::size_t   old_head{0};
+            std::size_t   old_reserve_head{0};
+            std::vector<std::size_t> late_reservations;
+            std::size_t   migrate_copied{0};
+            std::size_t   migrate_copy_end{0};
+            bool          migrate_copy_done{false};
+            std::thread   migrate_thread;
+            // idle reclaim (see Ring::set_idle_reclaim): idle_thread calls Ring::reclaim_idle()
+            //   once the head has not moved for idle_after, idle_stop ends it
+            std::chrono::milliseconds idle_after{0};
+            bool           idle_stop{false};
+            condition_type idle_condition;
+            std::thread    idle_thread;
+            // bumped whenever waiters are notified of a change the cursors do not show (guarantees,
+            //   sequences, reallocations), spinning waiters poll it with the cursors (see Ring::_wait)
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> wait_events{0};
+            // number of threads blocked on read_waiters/write_condition, used by the
+            //   spsc fast path to decide whether a notify (and thus the mutex) is needed
+            std::atomic<std::size_t> nread_waiting{0};
+            std::atomic<std::size_t> nwrite_waiting{0};
+            // how waits for space, data and sequences are done, see RBWaitPolicy
+            RBWaitPolicy wait_policy{RBWaitPolicy::WAIT_BLOCK};
+            std::size_t  spin_count{RINGBUFFER_DEFAULT_SPIN_COUNT};
+            // coalesced reader notification (see Ring::set_notify_coalescing), notified_head and
+            //   notified_time_ns track the last notification and are only updated by the writer
+            std::atomic<std::size_t>  notify_bytes{0};
+            std::atomic<std::int64_t> notify_interval_ns{0};
+            std::atomic<std::size_t>  notified_head{0};
+            std::atomic<std::int64_t> notified_time_ns{0};
+            // counters behind Ring::stats()
+            RingCounters counters;
+            // latency histograms, only recorded while histograms is set (see Ring::set_latency_histograms)
+            std::unique_ptr<RingHistograms> histograms_storage;
+            std::atomic<RingHistograms*>    histograms{nullptr};
+            // live-monitoring file under proclog::directory(), null if ProcLog is disabled
+            std::unique_ptr<proclog::ProcLog> proclog;
 
             int core{-1};
             int device{-1};
@@ -102,9 +199,23 @@ namespace ringbuffer {
             std::map<std::string,SequencePtr> sequence_map;
             std::map<std::size_t,SequencePtr> sequence_time_tag_map;
 
-            guarantee_set guarantees;
+            // Note: guarantees_mutex serializes adding/removing guarantees and recomputing
+            //         the earliest one, moving a guarantee forward does not need it.
+            GuaranteeTable guarantees;
             mutable mutex_type guarantees_mutex;
 
+            // shared memory rings: the segment holds the data, the guarantees and a copy of
+            //   the state for other processes. An attached ring (shm_attached) mirrors the state
+            //   of the writing process into this struct, shm_nsequence counts imported sequences.
+            shm::Segment  shm_segment;
+            shm::RingHeader* shm{nullptr};
+            bool          shm_attached{false};
+            // span and shm for Ring::stats, which reads them without the mutex (e.g. from the
+            //   ProcLog monitor thread), stored whenever they change
+            std::atomic<std::size_t>      stats_span{0};
+            std::atomic<shm::RingHeader*> stats_shm{nullptr};
+            std::uint64_t shm_nsequence{0};
+
         };
 
 
@@ -0,0 +1,171 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#ifndef RINGBUFFER_SHM_H
+#define RINGBUFFER_SHM_H
+
+#pragma warning( disable : 4251 ) // needs to have dll-interface to be used by clients of class
+
+#include "ringbuffer/common.h"
+#include "ringbuffer/visibility.h"
+#include "ringbuffer/types.h"
+#include "ringbuffer/detail/guarantee_table.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#ifndef RINGBUFFER_SHM_MAX_SEQUENCES
+    #define RINGBUFFER_SHM_MAX_SEQUENCES 256
+#endif
+#ifndef RINGBUFFER_SHM_MAX_NAME
+    #define RINGBUFFER_SHM_MAX_NAME 128
+#endif
+#ifndef RINGBUFFER_SHM_MAX_HEADER
+    #define RINGBUFFER_SHM_MAX_HEADER 1024
+#endif
+
+namespace ringbuffer {
+    namespace shm {
+
+        // Sequence as seen by other processes.
+        // Note: id is 0 while the descriptor is being (re)written and index+1 afterwards,
+        //         readers copy the fields and check that id did not change meanwhile.
+        struct SequenceDescriptor {
+            std::atomic<std::uint64_t> id{0};
+            std::atomic<std::size_t>   end{0};
+            time_tag_type time_tag{0};
+            std::size_t   nringlet{0};
+            std::size_t   begin{0};
+            std::size_t   header_size{0};
+            std::size_t   footer_size{0};
+            char          name[RINGBUFFER_SHM_MAX_NAME];
+            char          header[RINGBUFFER_SHM_MAX_HEADER];
+            char          footer[RINGBUFFER_SHM_MAX_HEADER];
+        };
+
+        // Control block at the start of a shared memory segment, the (mirrored) data follows
+        //   at data_offset. The geometry is fixed once the segment has been created.
+        // Note: Only atomics and plain data, so that it can be used from several processes.
+        struct RingHeader {
+            std::uint64_t magic{0};
+            std::uint32_t version{0};
+
+            std::size_t data_offset{0};
+            std::size_t ghost_span{0};
+            std::size_t span{0};
+            std::size_t stride{0};
+            std::size_t nringlet{0};
+            // process that created the segment, a segment whose creator is gone may be replaced
+            std::int64_t creator_pid{0};
+
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> tail{0};
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> head{0};
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> reserve_head{0};
+
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::uint32_t> writing_begun{0};
+            std::atomic<std::uint32_t> writing_ended{0};
+            std::atomic<std::size_t>   eod{0};
+            std::atomic<std::uint64_t> nsequence{0};
+
+            // event counters, bumped on every change and used as futex words
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::uint32_t> read_event{0};
+            std::atomic<std::uint32_t> nread_waiting{0};
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::uint32_t> write_event{0};
+            std::atomic<std::uint32_t> nwrite_waiting{0};
+
+            alignas(RINGBUFFER_CACHE_LINE_SIZE) std::atomic<std::uint32_t> guarantees_lock{0};
+            state::GuaranteeTable guarantees;
+
+            SequenceDescriptor sequences[RINGBUFFER_SHM_MAX_SEQUENCES];
+        };
+
+        struct Segment {
+            RingHeader* header{nullptr};
+            pointer     data{nullptr};
+            std::size_t span{0};
+            std::size_t nringlet{0};
+        };
+
+        /*
+         * create the named segment for a ring. An existing segment of the same name is only
+         * replaced if the process that created it is gone, otherwise (or if that cannot be
+         * told, e.g. for a segment of another version) STATUS_RING_NOT_AVAILABLE is returned.
+         */
+        RBStatus RINGBUFFER_EXPORT create(const std::string& name, std::size_t span, std::size_t ghost_span,
+                                          std::size_t nringlet, Segment* segment);
+
+        /*
+         * map the named segment created by another process
+         */
+        RBStatus RINGBUFFER_EXPORT attach(const std::string& name, Segment* segment);
+
+        /*
+         * unmap the segment, the name stays valid until unlink
+         */
+        RBStatus RINGBUFFER_EXPORT detach(Segment* segment);
+
+        RBStatus RINGBUFFER_EXPORT unlink(const std::string& name);
+
+        /*
+         * process-shared lock on a futex word
+         */
+        void RINGBUFFER_EXPORT lock(std::atomic<std::uint32_t>& word);
+        void RINGBUFFER_EXPORT unlock(std::atomic<std::uint32_t>& word);
+
+        /*
+         * wait until event differs from expected, a spurious return is possible (timeout=0 waits infinitely)
+         */
+        void RINGBUFFER_EXPORT wait(std::atomic<std::uint32_t>& event, std::uint32_t expected,
+                                    std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
+
+        /*
+         * bump event and wake all processes waiting on it
+         */
+        void RINGBUFFER_EXPORT notify(std::atomic<std::uint32_t>& event, const std::atomic<std::uint32_t>& nwaiting);
+
+    }
+}
+
+#endif //RINGBUFFER_SHM_H
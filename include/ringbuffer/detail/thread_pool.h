@@ -0,0 +1,97 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#ifndef RINGBUFFER_THREAD_POOL_H
+#define RINGBUFFER_THREAD_POOL_H
+
+#include "ringbuffer/common.h"
+#include "ringbuffer/visibility.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ringbuffer {
+    namespace util {
+
+        // Fixed set of worker threads that run one job at a time, every worker calls the
+        //   job with its index. Used to split large host copies and prefaulting
+        //   (see memory::memcpy2DParallel).
+        // Note: Uses std threads also in fiber builds, jobs must not block on fiber primitives.
+        class RINGBUFFER_EXPORT ThreadPool {
+        public:
+            // worker t is pinned to thread_cores[t] if given and not -1
+            explicit ThreadPool(std::size_t nthread, const std::vector<int>& thread_cores={});
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            inline std::size_t size() const { return m_threads.size(); }
+
+            // Runs fn(t) on every worker t and, if caller_runs, fn(size()) on the calling thread,
+            //   and returns when all are done. Returns false without running fn if another job is
+            //   in progress or the pool belongs to a parent process.
+            bool try_run(const std::function<void(std::size_t)>& fn, bool caller_runs=true);
+
+        private:
+            void worker(std::size_t t, int core);
+
+            std::vector<std::thread> m_threads;
+            std::mutex               m_run_mutex; // held for the duration of a job
+            std::mutex               m_mutex;
+            std::condition_variable  m_start;
+            std::condition_variable  m_done;
+            const std::function<void(std::size_t)>* m_job{nullptr};
+            std::size_t              m_generation{0};
+            std::size_t              m_pending{0};
+            bool                     m_stop{false};
+            int                      m_pid{0};
+        };
+
+    }
+}
+
+#endif //RINGBUFFER_THREAD_POOL_H
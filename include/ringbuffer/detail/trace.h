@@ -47,11 +47,17 @@
 #include "ringbuffer/config.h"
 #include "ringbuffer/detail/cuda.h"
 
+#include <cstdint>
 #include <map>
+#include <ostream>
 #include <queue>
 #include <string>
 #include <cstring>
 
+#ifndef RINGBUFFER_TRACE_EVENTS
+    #define RINGBUFFER_TRACE_EVENTS 65536
+#endif
+
 #ifdef RINGBUFFER_WITH_NVTOOLSEXT
 #include <nvToolsExt.h>
 #endif //RINGBUFFER_WITH_NVTOOLSEXT
@@ -85,6 +91,28 @@ namespace ringbuffer {
             inline uint32_t get_color(unsigned hash);
         } // namespace profile_detail
 
+        /*
+         * CPU trace backend: every RB_TRACE scope is recorded as a complete event into a buffer
+         *   owned by the calling thread (RINGBUFFER_TRACE_EVENTS per thread, later events are
+         *   dropped and counted). The buffers are written without locks and can be dumped as
+         *   Chrome Trace Event JSON, which chrome://tracing and ui.perfetto.dev open directly.
+         * Note: If RINGBUFFER_TRACE_FILE is set, the trace is written there at exit.
+         */
+        namespace cpu {
+            // nanoseconds since the trace epoch (first use in this process)
+            std::uint64_t RINGBUFFER_EXPORT now();
+            // Note: name must stay valid until the trace is dumped, see intern
+            void RINGBUFFER_EXPORT record(const char* name, std::uint64_t begin, std::uint64_t end);
+            // stable copy of a dynamic scope name
+            RINGBUFFER_EXPORT const char* intern(const std::string& name);
+        } // namespace cpu
+
+        void RINGBUFFER_EXPORT dump(std::ostream& out);
+        RBStatus RINGBUFFER_EXPORT dump(const std::string& filename);
+        // Note: Only while no traced scopes are running
+        void RINGBUFFER_EXPORT clear();
+        std::size_t RINGBUFFER_EXPORT getDroppedEvents();
+
 #ifdef RINGBUFFER_WITH_CUDA
 
         namespace nvtx {
@@ -113,11 +141,14 @@ namespace ringbuffer {
 #endif // RINGBUFFER_WITH_CUDA
 
         class ScopedTracer {
+            const char*   _cpu_name;
+            std::uint64_t _cpu_begin;
+#ifdef RINGBUFFER_WITH_CUDA
             std::string _name;
             uint32_t _color;
             uint32_t _category;
-#ifdef RINGBUFFER_WITH_CUDA
             cudaStream_t _stream;
+            void start();
 #ifdef RINGBUFFER_WITH_NVTOOLSEXT
             void build_attrs(nvtxEventAttributes_t *attrs);
 #endif
@@ -128,11 +159,16 @@ namespace ringbuffer {
             ScopedTracer &operator=(ScopedTracer const &) = delete;
 
 #ifdef RINGBUFFER_WITH_CUDA
+            explicit ScopedTracer(const char* name, cudaStream_t stream = nullptr);
             explicit ScopedTracer(const std::string& name, cudaStream_t stream = nullptr);
             ~ScopedTracer();
 #else
-            explicit ScopedTracer(std::string name) : _name(std::move(name)) {}
-            ~ScopedTracer() {};
+            // Note: name is expected to be a literal (as passed by RB_TRACE), others are interned
+            explicit ScopedTracer(const char* name) : _cpu_name(name), _cpu_begin(cpu::now()) {}
+            explicit ScopedTracer(const std::string& name) : _cpu_name(cpu::intern(name)), _cpu_begin(cpu::now()) {}
+            ~ScopedTracer() {
+                cpu::record(_cpu_name, _cpu_begin, cpu::now());
+            };
 #endif
         };
     }
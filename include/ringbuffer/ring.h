@@ -49,13 +49,18 @@
 #include "ringbuffer/common.h"
 #include "ringbuffer/visibility.h"
 #include "ringbuffer/types.h"
+#include "ringbuffer/ring_stats.h"
+#include "ringbuffer/detail/memory.h"
 #include "ringbuffer/detail/ring_state.h"
 #include "ringbuffer/detail/signal.h"
 
 #include <spdlog/logger.h>
 #include <spdlog/spdlog.h>
+#include <array>
 #include <memory>
 #include <chrono>
+#include <functional>
+#include <vector>
 
 namespace ringbuffer {
 
@@ -66,36 +71,140 @@ namespace ringbuffer {
         friend class WriteSequence;
         friend class state::RingReallocLock;
         friend class state::Guarantee;
+        friend class WriteBatch;
 
         std::unique_ptr<state::RingState> m_state;
 
         std::size_t _buf_offset( std::size_t offset) const;
         pointer  _buf_pointer(std::size_t offset) const;
 
-        void _ghost_write(std::size_t offset, std::size_t size);
+        // Note: origin is the offset the data pointer was taken from (the begin of the reservation),
+        //         it differs from offset for the partial commits of a WriteBatch
+        void _ghost_write(std::size_t offset, std::size_t size, std::size_t origin);
         void _ghost_read( std::size_t offset, std::size_t size);
 
         void _copy_to_ghost(  std::size_t buf_offset, std::size_t span);
         void _copy_from_ghost(std::size_t buf_offset, std::size_t span);
 
+        // hugepages returns the pages that back the new buffer
+        pointer _allocate_buffer(std::size_t ghost_span, std::size_t span, std::size_t stride, std::size_t nringlet,
+                                 RBHugePages* hugepages);
+        std::vector<int> _resize_thread_cores(int node) const;
+        // applies the NUMA policy to a new buffer, returns the node of every ringlet
+        std::vector<int> _place_buffer(pointer buf, std::size_t stride, std::size_t nringlet);
+        void _free_buffer(pointer buf, std::size_t span, std::size_t stride, std::size_t nringlet, RBHugePages hugepages,
+                          bool memlocked);
+        // geometry of a buffer that holds the requested spans and at least the current ones
+        state::BufferInfo _resize_geometry(std::size_t contiguous_span, std::size_t total_span, std::size_t nringlet) const;
+        // geometry of a buffer that holds exactly the given spans, rounded as the ring requires
+        state::BufferInfo _buffer_geometry(std::size_t contiguous_span, std::size_t total_span, std::size_t nringlet) const;
+        // allocates, places, prefaults and locks the buffer of info, thread_cores returns the cores of
+        //   the resize threads (empty if the work is not split)
+        void _prepare_buffer(state::BufferInfo* info, std::vector<int>* thread_cores);
+
+        // incremental resize, see set_incremental_resize
+        bool _incremental_resize_possible(std::size_t nringlet) const;
+        void _resize_incremental(state::unique_lock_type& lock, state::BufferInfo info);
+        void _migrate_old_buffer(std::vector<int> thread_cores);
+        // copies [begin, end) from the old to the current buffer (without ghost regions)
+        void _copy_from_old_buffer(std::size_t begin, std::size_t end, const std::vector<int>& thread_cores);
+        // copies [begin, begin+size) of a write span reserved at origin in the old buffer
+        void _copy_span_from_old_buffer(std::size_t origin, std::size_t begin, std::size_t size);
+        std::size_t _old_buf_offset(std::size_t offset) const;
+        // true if the write span reserved at origin points into the old buffer
+        bool _old_write_span(std::size_t origin) const;
+        bool _in_old_buffer(const void* data) const;
+        // called whenever a span is closed while the old buffer is alive
+        void _close_old_span(bool in_old_buffer);
+        void _free_old_buffer_if_done();
+        // false while readers of [begin, end) would still see data that is only in the old buffer
+        bool _migration_covers(std::size_t begin, std::size_t end) const;
+        // false while reserving up to reserve_head would overwrite the chunk being migrated
+        bool _migration_allows(std::size_t reserve_head) const;
+
+        // shrink and idle reclaim
+        // earliest offset a guarantee protects, clamped to [tail, head]
+        std::size_t _earliest_guarantee();
+        // moves the tail forward to new_tail and returns the number of bytes dropped
+        std::size_t _drop_to(std::size_t new_tail);
+        std::size_t _resident_size() const;
+        bool _idle_reclaim_possible() const;
+        RingReclaim _reclaim_idle();
+        void _idle_reclaim_loop();
+        void _stop_idle_reclaim(state::unique_lock_type& lock);
+
         RBStatus _advance_reserve_head(state::unique_lock_type& lock, std::size_t size, bool nonblocking, std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
 
-        void _add_guarantee(std::size_t offset);
-        void _remove_guarantee(std::size_t offset);
-        std::size_t _get_earliest_guarantee();
+        std::size_t _add_guarantee(std::size_t offset, int* slot);
+        void _remove_guarantee(int slot);
+        std::size_t _move_guarantee(int slot, std::size_t offset);
+        std::size_t _clamp_guarantee(std::size_t offset) const;
+        bool _guarantees_allow(std::size_t reserve_head);
+        state::GuaranteeTable& _guarantee_table();
+
+        // waits on condition, or on the shared memory events for rings that are shared between processes,
+        //   after spinning according to the wait policy. nwaiting (optional) counts blocked waiters.
+        RBStatus _wait(state::unique_lock_type& lock, state::condition_type& condition,
+                       std::atomic<std::size_t>* nwaiting,
+                       std::chrono::nanoseconds timeout, const std::function<bool()>& predicate);
+        // atomic cursors and event counters that spinning waiters poll without the mutex
+        std::array<std::size_t, 5> _wait_snapshot() const;
+        // _wait for readers, re-checks predicate at least every notify interval (see set_notify_coalescing)
+        RBStatus _wait_for_data(state::unique_lock_type& lock, state::condition_type& condition,
+                                std::chrono::nanoseconds timeout, const std::function<bool()>& predicate);
+        void _discard_old_sequences();
+
+        // shared memory rings
+        void _shm_attach();
+        void _shm_sync();
+        void _shm_refresh_sequence(const SequencePtr& sequence);
+        void _shm_publish_sequence(const SequencePtr& sequence);
+        void _shm_finish_sequence(const SequencePtr& sequence);
+
+        // spsc fast path: these return false if the caller has to fall back to the locked path
+        bool _reserve_span_spsc(std::size_t size, std::size_t* begin, void** data);
+        bool _commit_span_spsc(std::size_t origin, std::size_t begin, std::size_t reserve_size, std::size_t commit_size);
+        bool _acquire_span_spsc(ReadSequence* sequence, std::size_t offset, std::size_t* size, std::size_t* begin, void** data);
+        // try_acquire_span without the entry/return probes
+        RBStatus _try_acquire_span(ReadSequence* sequence, std::size_t offset, std::size_t* size, std::size_t* begin,
+                                   void** data, bool nonblocking, std::chrono::nanoseconds timeout);
+        bool _sequence_discard_pending(std::size_t new_tail) const;
+        bool _ghost_write_pending(std::size_t offset, std::size_t size, std::size_t origin) const;
+        bool _ghost_read_pending(std::size_t offset, std::size_t size) const;
+        void _close_span(std::atomic<std::size_t>& nopen);
+        void _notify_waiters(state::condition_type& condition, const std::atomic<std::size_t>& nwaiting);
+        void _notify_readers();
+        // coalesced notification: true if readers should be told about the data up to head now
+        bool _notify_due(std::size_t head);
+        // latency histograms: commit timestamps and commit-to-acquire delays
+        void _record_commit(std::size_t head);
+        void _record_acquire(std::size_t end);
+
+        // ProcLog entry (see proclog.h), the static part is refreshed whenever the geometry changes
+        void _open_proclog(const std::string& filename);
+        void _update_proclog_static();
+        std::string _proclog_contents() const;
+
+        // partial commits for WriteBatch, origin is the begin of the reservation
+        void _commit_span(std::size_t origin, std::size_t begin, std::size_t reserve_size, std::size_t commit_size);
+        // makes [begin, begin+size) of the open span visible to readers, the rest stays reserved
+        void _publish_span(std::size_t origin, std::size_t begin, std::size_t size);
 
         bool _sequence_still_within_ring(SequencePtr sequence) const;
         std::size_t _get_start_of_sequence_within_ring(SequencePtr sequence) const;
-        SequencePtr _get_earliest_or_latest_sequence(state::unique_lock_type& lock, bool latest, std::chrono::nanoseconds timeout) const;
+        SequencePtr _get_earliest_or_latest_sequence(state::unique_lock_type& lock, bool latest, std::chrono::nanoseconds timeout);
 
         SequencePtr open_earliest_or_latest_sequence(bool with_guarantee,
                                                      std::unique_ptr<state::Guarantee>& guarantee,
                                                      bool latest, std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
-        SequencePtr _get_next_sequence(SequencePtr sequence,
-                                       state::unique_lock_type& lock, std::chrono::nanoseconds timeout) const;
+        RBStatus _get_next_sequence(SequencePtr sequence, state::unique_lock_type& lock,
+                                    bool nonblocking, std::chrono::nanoseconds timeout, SequencePtr* next);
 
         void increment_sequence_to_next(SequencePtr& sequence,
                                         std::unique_ptr<state::Guarantee>& guarantee, std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
+        RBStatus try_increment_sequence_to_next(SequencePtr& sequence,
+                                                std::unique_ptr<state::Guarantee>& guarantee,
+                                                bool nonblocking, std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
         SequencePtr _get_sequence_by_name(const std::string& name);
 
         SequencePtr open_sequence_by_name(const std::string& name,
@@ -130,6 +239,9 @@ namespace ringbuffer {
         static std::shared_ptr<Ring> create(std::string name, RBSpace space) {
             return std::shared_ptr<Ring>( new Ring(name, space) );
         }
+        // attach to a SPACE_SHM ring that was created (and resized) by another process,
+        //   the returned ring can only be used for reading
+        static std::shared_ptr<Ring> attach(std::string name);
         ~Ring();
 
         // public interface
@@ -141,8 +253,102 @@ namespace ringbuffer {
         inline RBSpace     space()    const { return m_state->space; }
         inline void        set_core(int core)  { m_state->core = core; }
         inline int         core()    const { return m_state->core; }
+        // cores that share the cache of the given level with core() (see affinity::topologyGetCacheCores),
+        //   e.g. to place the writer and readers of the ring in the same L3 domain
+        std::vector<int>   cores_sharing_cache(int level=3) const;
         inline void        set_device(int device)  { m_state->device = device; }
         inline int         device()    const { return m_state->device; }
+        // Note: In spsc mode all writer-side calls (sequences and spans) must come from one
+        //         thread and all reader-side calls from one other thread.
+        void               set_spsc(bool enabled);
+        inline bool        spsc()      const { return m_state->spsc; }
+        // Note: Mirrored storage is only available for SPACE_SYSTEM and must be selected
+        //         before the first resize. The ring span becomes a multiple of the page size.
+        void               set_mirrored(bool enabled);
+        inline bool        mirrored()  const { return m_state->mirrored; }
+        // Note: Huge pages are only available for SPACE_SYSTEM rings without mirrored storage and
+        //         apply from the next reallocation on, which rounds the stride up to the huge page size.
+        //         hugepages_in_use() reports the pages actually used after falling back.
+        void               set_hugepages(RBHugePages pages);
+        inline RBHugePages hugepages() const { return m_state->hugepages; }
+        inline RBHugePages hugepages_in_use() const { return m_state->buf_hugepages; }
+        // Note: Prefaulting writes every page of a newly allocated buffer during resize, from a
+        //         thread pinned to core() if set, so writers do not take page faults on the first lap.
+        //         Locking keeps the buffer resident (mlock); memlocked() reports whether it succeeded.
+        //         Both are host-memory only and apply from the next reallocation on.
+        void               set_prefault(bool enabled);
+        inline bool        prefault()  const { return m_state->prefault; }
+        void               set_memlock(bool enabled);
+        inline bool        memlock()   const { return m_state->memlock; }
+        inline bool        memlocked() const { return m_state->buf_memlocked; }
+        // Note: Reallocations of host rings prefault and migrate the buffer with nthread worker
+        //         threads, pinned to the given cores (round robin) or else to the cores of the
+        //         NUMA node the buffer is bound to or of core() (with NUMA support).
+        //         nthread=1 does all work in resize.
+        void               set_resize_threads(std::size_t nthread, const std::vector<int>& cores={});
+        inline std::size_t resize_threads() const { return m_state->resize_nthread; }
+        // Note: Incremental resizes of SPACE_SYSTEM rings do not wait for open spans. The new buffer
+        //         is allocated while the ring keeps running and writers continue into it right away,
+        //         while a background thread copies the data that was in the ring. Spans opened before
+        //         the switch keep pointing to the old buffer, which is freed once they are closed and
+        //         the copy has finished. Readers of data that has not been copied yet wait for it.
+        //         The ring falls back to a blocking resize in spsc mode, for mirrored rings and when
+        //         the number of ringlets grows. resize_pending() is true until the old buffer is freed.
+        void               set_incremental_resize(bool enabled);
+        inline bool        incremental_resize() const { return m_state->incremental_resize; }
+        bool               resize_pending() const;
+        // Note: Reallocates to a smaller buffer, as resize only ever grows it, and keeps the newest
+        //         data that fits. The total span does not go below what the earliest guarantee still
+        //         protects, unguaranteed readers lose the data that is dropped. Waits for open spans
+        //         like a blocking resize, the number of ringlets stays. Not for shared memory rings.
+        RingReclaim        shrink(std::size_t max_contiguous_span, std::size_t max_total_size);
+        // Note: Gives the pages of the free space between the head and the tail of the previous lap
+        //         back to the kernel. The tail does not move and no data is dropped, use shrink for
+        //         that. Nothing is done while spans are open, a resize is pending, in spsc mode or
+        //         for locked memory. SPACE_SYSTEM rings only.
+        RingReclaim        reclaim_idle();
+        // Note: Calls reclaim_idle() from a background thread once the head has not moved for
+        //         idle_after, and logs the resident size before and after. 0 disables it.
+        void               set_idle_reclaim(std::chrono::milliseconds idle_after);
+        inline std::chrono::milliseconds idle_reclaim() const { return m_state->idle_after; }
+        // bytes of the buffer that are resident in RAM (host rings, 0 otherwise)
+        std::size_t        resident_size() const;
+        // Note: NUMA placement of SPACE_SYSTEM and SPACE_SHM buffers, applied on every reallocation
+        //         before prefaulting. NUMA_NODE takes one node, NUMA_INTERLEAVE and NUMA_RINGLETS the
+        //         nodes to use (all if empty). NUMA_RINGLETS rounds the stride up to whole pages.
+        //         The default NUMA_CORE binds to the node of core() if it is set.
+        //         numa_nodes_in_use() reports the node of every ringlet of the current buffer
+        //         (-1 if it is not bound to a single node).
+        void               set_numa_policy(RBNumaPolicy policy, const std::vector<int>& nodes={});
+        inline RBNumaPolicy numa_policy() const { return m_state->numa_policy; }
+        inline std::vector<int> numa_nodes() const { return m_state->numa_nodes; }
+        inline std::vector<int> numa_nodes_in_use() const { return m_state->buf_numa_nodes; }
+        // Note: Moves the pages of the current buffer to node in place, in chunks of chunk_size
+        //         bytes, while writers and readers keep going (a page is only inaccessible while
+        //         the kernel copies it). The ring switches to NUMA_NODE on node so that later
+        //         reallocations stay there. progress is called after every chunk with the bytes
+        //         done, the total and the bytes moved so far. Returns the number of bytes moved,
+        //         pages not faulted in yet are not counted. A concurrent resize waits for the
+        //         migration to finish. Host rings with NUMA support only.
+        using migrate_progress_type = std::function<void(std::size_t done, std::size_t total, std::size_t moved)>;
+        std::size_t        migrate_to_node(int node, const migrate_progress_type& progress={},
+                                           std::size_t chunk_size=RINGBUFFER_MIGRATE_CHUNK_SIZE);
+        // Note: Spinning policies trade a busy core for wakeup latency, spin_count is the number
+        //         of spin iterations before WAIT_SPIN_YIELD yields or WAIT_ADAPTIVE blocks.
+        void               set_wait_policy(RBWaitPolicy policy, std::size_t spin_count=RINGBUFFER_DEFAULT_SPIN_COUNT);
+        inline RBWaitPolicy wait_policy() const { return m_state->wait_policy; }
+        inline std::size_t spin_count() const { return m_state->spin_count; }
+        // Coalesced reader notification: commits only wake readers once bytes have accumulated
+        //   since the last notification or interval has passed, whichever comes first.
+        //   Blocked readers re-check at least every interval, finish_sequence and end_writing
+        //   always notify. bytes=0 coalesces by time only, interval=0 notifies on every commit.
+        // Note: The setting is per process, attached shared memory rings need it as well.
+        void               set_notify_coalescing(std::size_t bytes, std::chrono::microseconds interval);
+        inline std::size_t notify_bytes() const { return m_state->notify_bytes.load(); }
+        inline std::chrono::microseconds notify_interval() const {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(m_state->notify_interval_ns.load()));
+        }
+        inline bool        attached()  const { return m_state->shm_attached; }
         inline void        lock()   { m_state->mutex.lock(); }
         inline void        unlock() { m_state->mutex.unlock(); }
         inline void*       locked_data()            const { return m_state->buf; }
@@ -156,17 +362,22 @@ namespace ringbuffer {
 
         inline bool writing_ended() { return m_state->writing_ended; }
 
-        inline std::size_t current_tail_offset() const {
-            const auto& state = get_state();
-            state::lock_guard_type lock(state.mutex);
-            return state.tail;
-        }
+        std::size_t current_tail_offset() const;
+
+        // snapshot of the ring counters and state, does not take the mutex
+        RingStats stats() const;
+        // Note: Latency histograms cost a clock read per commit and acquire, so they are off by default.
+        //         Disabling keeps the recorded values.
+        void set_latency_histograms(bool enabled);
+        RingLatencies latencies() const;
         
         inline std::size_t current_stride() const {
             const auto& state = get_state();
             state::lock_guard_type lock(state.mutex);
             return state.stride;
         }
+        // stride of the buffer data points into, spans opened before an incremental resize keep the old one
+        std::size_t span_stride(const void* data) const;
         
         inline std::size_t current_nringlet() const {
             const auto& state = get_state();
@@ -192,9 +403,24 @@ namespace ringbuffer {
                           std::size_t* begin,
                           void**      data,
                           std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
+        // data (optional) is the pointer returned by acquire_span, spans acquired before an
+        //   incremental resize keep the old buffer alive until they are released with it
         void release_span(ReadSequence* sequence,
                           std::size_t  begin,
-                          std::size_t  size);
+                          std::size_t  size,
+                          const void*  data=nullptr);
+
+        // Non-throwing variants for polling loops: STATUS_WOULD_BLOCK, STATUS_WAIT_TIMEOUT and
+        //   STATUS_END_OF_DATA (and invalid arguments) are returned instead of thrown.
+        //   The outputs are only valid if STATUS_SUCCESS is returned.
+        RBStatus try_reserve_span(std::size_t size, std::size_t* begin, void** data, bool nonblocking, std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
+        RBStatus try_acquire_span(ReadSequence* sequence,
+                                  std::size_t  offset,
+                                  std::size_t* size,
+                                  std::size_t* begin,
+                                  void**      data,
+                                  bool        nonblocking,
+                                  std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
 
 
 
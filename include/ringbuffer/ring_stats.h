@@ -0,0 +1,137 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#ifndef RINGBUFFER_RING_STATS_H
+#define RINGBUFFER_RING_STATS_H
+
+#include "ringbuffer/common.h"
+#include "ringbuffer/visibility.h"
+#include "ringbuffer/types.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ringbuffer {
+
+    /*
+     * Percentiles of a latency histogram, see Ring::latencies()
+     *
+     * Note: Values are upper bounds of log-spaced buckets, accurate to within 12.5%.
+     */
+    struct RINGBUFFER_EXPORT LatencySummary {
+        std::uint64_t            count{0};
+        std::chrono::nanoseconds p50{0};
+        std::chrono::nanoseconds p99{0};
+        std::chrono::nanoseconds p999{0};
+        std::chrono::nanoseconds max{0};
+    };
+
+    struct RINGBUFFER_EXPORT RingLatencies {
+        // writers blocked on guarantees in reserve
+        LatencySummary reserve_wait;
+        // out-of-order commits waiting for earlier spans
+        LatencySummary commit_wait;
+        // readers blocked on data in acquire
+        LatencySummary acquire_wait;
+        // from the commit that completed a span to its acquisition, per span
+        LatencySummary commit_to_acquire;
+    };
+
+    /*
+     * Result of Ring::shrink and Ring::reclaim_idle
+     *
+     * Note: Resident sizes are those of the ring buffer itself (see Ring::resident_size()),
+     *         not of the whole process.
+     */
+    struct RINGBUFFER_EXPORT RingReclaim {
+        std::size_t resident_before{0};
+        std::size_t resident_after{0};
+        // bytes of data readers could no longer reach afterwards (shrink only, the tail moved past them)
+        std::size_t bytes_dropped{0};
+    };
+
+    /*
+     * Snapshot of the counters of a ring, see Ring::stats()
+     *
+     * Note: The counters are read one by one without the mutex, so a snapshot
+     *         taken while the ring is in use is only approximately consistent.
+     */
+    struct RINGBUFFER_EXPORT RingStats {
+        // writer side
+        std::uint64_t bytes_committed{0};
+        std::uint64_t spans_committed{0};
+        // reader side (all readers)
+        std::uint64_t bytes_acquired{0};
+        std::uint64_t spans_acquired{0};
+        // bytes requested by unguaranteed readers that were overwritten before they got to them
+        std::uint64_t bytes_overwritten{0};
+
+        // ghost region copies: after writes that wrapped into the ghost region,
+        //   and before reads that wrap and need the dirty front of the buffer
+        std::uint64_t ghost_bytes_written{0};
+        std::uint64_t ghost_bytes_read{0};
+
+        // writers that had to wait for guarantees (or a reallocation)
+        std::uint64_t write_waits{0};
+        std::chrono::nanoseconds write_wait_time{0};
+        // readers that had to wait for data
+        std::uint64_t read_waits{0};
+        std::chrono::nanoseconds read_wait_time{0};
+
+        std::uint64_t reallocs{0};
+
+        // current state
+        std::size_t span{0};
+        std::size_t tail{0};
+        std::size_t head{0};
+        std::size_t reserve_head{0};
+        // bytes between tail and head
+        std::size_t fill{0};
+        // distance of each active guarantee behind the head
+        std::vector<std::size_t> guarantee_lag;
+    };
+
+}
+
+#endif //RINGBUFFER_RING_STATS_H
@@ -51,6 +51,8 @@
 #include "ringbuffer/visibility.h"
 #include "ringbuffer/types.h"
 
+#include <atomic>
+
 namespace ringbuffer {
 
 
@@ -63,11 +65,13 @@ namespace ringbuffer {
         time_tag_type  m_time_tag;
         std::size_t    m_nringlet;
         std::size_t    m_begin;
-        std::size_t    m_end;
+        // atomic so that the spsc fast path can check for the end without the ring mutex
+        std::atomic<std::size_t> m_end;
         header_type    m_header;
         footer_type    m_footer;
         SequencePtr    m_next;
         std::size_t    m_readrefcount; // ever used ??
+        std::size_t    m_shm_index; // index of the descriptor for shared memory rings
 
     public:
         Sequence(const std::weak_ptr<Ring>&  ring,
@@ -148,6 +152,9 @@ namespace ringbuffer {
 		ReadSequence& operator=(ReadSequence&&);
 
         void increment_to_next(std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
+        // Non-throwing: returns STATUS_WOULD_BLOCK, STATUS_WAIT_TIMEOUT or STATUS_END_OF_DATA
+        //   and stays on the current sequence if there is no next one (yet)
+        RBStatus try_increment_to_next(bool nonblocking=true, std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
 
         inline std::unique_ptr<state::Guarantee>&       guarantee()       { return m_guarantee; }
         inline std::unique_ptr<state::Guarantee> const& guarantee() const { return m_guarantee; }
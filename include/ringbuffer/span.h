@@ -74,7 +74,8 @@ namespace ringbuffer {
 
         std::weak_ptr<Ring> ring() const;
         std::size_t     size() const;
-        // Note: These two are only safe to read while a span is open (preventing resize)
+        // Note: These two are only safe to read while a span is open (preventing resize),
+        //         the stride is the one of the buffer the span points into
         std::size_t     stride() const;
         std::size_t     nringlet() const;
 
@@ -87,6 +88,7 @@ namespace ringbuffer {
         std::size_t     m_begin;
         std::size_t     m_commit_size;
         void*           m_data;
+        bool            m_valid;
     public:
         // No copy or move
         WriteSpan(WriteSpan const& )            = delete;
@@ -95,8 +97,13 @@ namespace ringbuffer {
         WriteSpan& operator=(WriteSpan&& )      = delete;
 
         WriteSpan(const std::weak_ptr<Ring>& ring, std::size_t size, bool nonblocking, std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
+        // Non-throwing: *status receives the result of the reservation, unless it is
+        //   STATUS_SUCCESS the span is not valid and has size 0
+        WriteSpan(const std::weak_ptr<Ring>& ring, std::size_t size, bool nonblocking, RBStatus* status, std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
         ~WriteSpan() override;
 
+        inline bool     valid() const { return m_valid; }
+
         WriteSpan* commit(std::size_t size);
 
         void*           data() const override;
@@ -108,10 +115,56 @@ namespace ringbuffer {
     };
     
     
+    // Appends many small records to one reservation.
+    //
+    // The batch reserves 'capacity' bytes at a time and hands out space for records from it.
+    //   flush() publishes the records appended so far with one partial commit, commit() (or the
+    //   destructor) commits them and releases the reservation. A record that does not fit the
+    //   remaining reservation commits the batch and reserves a new one.
+    // Note: Records are only written to the first ringlet, capacity must not exceed
+    //         the max_contiguous_span of the ring.
+    class RINGBUFFER_EXPORT WriteBatch {
+        std::weak_ptr<Ring> m_ring;
+        std::size_t     m_capacity;
+        bool            m_nonblocking;
+        std::chrono::nanoseconds m_timeout;
+        std::size_t     m_begin;     // ring offset of the open reservation
+        std::size_t     m_reserved;  // size of the open reservation
+        std::size_t     m_published; // bytes of the reservation already visible to readers
+        std::size_t     m_used;      // bytes of the reservation handed out to records
+        uint8_t*        m_data;
+        bool            m_open;
+
+        void _reserve();
+    public:
+        // No copy or move
+        WriteBatch(WriteBatch const& )            = delete;
+        WriteBatch& operator=(WriteBatch const& ) = delete;
+        WriteBatch(WriteBatch&& )                 = delete;
+        WriteBatch& operator=(WriteBatch&& )      = delete;
+
+        WriteBatch(const std::weak_ptr<Ring>& ring, std::size_t capacity, bool nonblocking=false,
+                   std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
+        ~WriteBatch();
+
+        // returns space for a record of size bytes
+        void*       allocate(std::size_t size);
+        void        append(const void* data, std::size_t size);
+        // publishes the records appended so far, returns the number of bytes published
+        std::size_t flush();
+        void        commit();
+
+        inline std::size_t capacity() const { return m_capacity; }
+        // bytes appended but not yet visible to readers
+        inline std::size_t pending()  const { return m_used - m_published; }
+    };
+
+
     class RINGBUFFER_EXPORT ReadSpan : public Span {
         ReadSequence*   m_sequence;
         std::size_t     m_begin;
         void*           m_data;
+        bool            m_valid;
 
     public:
         // No copy or move
@@ -124,8 +177,18 @@ namespace ringbuffer {
                  std::size_t  offset,
                  std::size_t  size,
                  std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
+        // Non-throwing: *status receives the result of the acquisition, unless it is
+        //   STATUS_SUCCESS the span is not valid and has size 0
+        ReadSpan(ReadSequence* sequence,
+                 std::size_t  offset,
+                 std::size_t  size,
+                 bool         nonblocking,
+                 RBStatus*    status,
+                 std::chrono::nanoseconds timeout=std::chrono::nanoseconds(0));
         ~ReadSpan();
 
+        inline bool valid() const { return m_valid; }
+
         std::size_t size_overwritten() const;
 
         void*       data()     const override;
@@ -21,6 +21,10 @@
 #include <boost/thread/lock_traits.hpp>
 #endif
 
+#ifndef RINGBUFFER_CACHE_LINE_SIZE
+    #define RINGBUFFER_CACHE_LINE_SIZE 64
+#endif
+
 namespace ringbuffer {
 
     // Forward Declarations
@@ -44,14 +48,13 @@ namespace ringbuffer {
     typedef unsigned long long   time_tag_type;
     typedef   signed long long   delta_type;
 
-    typedef std::map<std::size_t,std::size_t> guarantee_set; // offset-->count
-
 
     namespace state {
         // Forward Declarations
         struct RINGBUFFER_EXPORT RingState;
         class RINGBUFFER_EXPORT RingReallocLock;
         class RINGBUFFER_EXPORT Guarantee;
+        struct RINGBUFFER_EXPORT GuaranteeTable;
 
         // type definitions
 #ifdef RINGBUFFER_BOOST_FIBER
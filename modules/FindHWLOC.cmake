@@ -0,0 +1,29 @@
+# - Find HWLOC
+# Find the hwloc library and includes
+#
+# HWLOC_INCLUDE_DIRS - where to find hwloc.h, etc.
+# HWLOC_LIBRARIES - List of libraries when using hwloc.
+# HWLOC_FOUND - True if hwloc found.
+
+find_path(HWLOC_INCLUDE_DIRS
+        NAMES hwloc.h
+        HINTS ${HWLOC_ROOT_DIR}/include)
+
+find_library(HWLOC_LIBRARIES
+        NAMES hwloc
+        HINTS ${HWLOC_ROOT_DIR}/lib)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(HWLOC DEFAULT_MSG HWLOC_LIBRARIES HWLOC_INCLUDE_DIRS)
+
+mark_as_advanced(
+        HWLOC_LIBRARIES
+        HWLOC_INCLUDE_DIRS)
+
+if(HWLOC_FOUND AND NOT (TARGET HWLOC::HWLOC))
+    add_library (HWLOC::HWLOC UNKNOWN IMPORTED)
+    set_target_properties(HWLOC::HWLOC
+            PROPERTIES
+            IMPORTED_LOCATION ${HWLOC_LIBRARIES}
+            INTERFACE_INCLUDE_DIRECTORIES ${HWLOC_INCLUDE_DIRS})
+endif()
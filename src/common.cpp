@@ -43,9 +43,14 @@
 
 
 #include "ringbuffer/common.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 
 static thread_local bool g_debug_enabled = true;
+// -1: not yet initialized from the RINGBUFFER_PROCLOG environment variable
+static std::atomic<int> g_proclog_enabled{-1};
 
 namespace ringbuffer {
 
@@ -97,6 +102,37 @@ namespace ringbuffer {
         }
     }
 
+    std::string getWaitPolicyString(RBWaitPolicy policy) {
+        switch( policy ) {
+            case RBWaitPolicy::WAIT_BLOCK:      return "block";
+            case RBWaitPolicy::WAIT_SPIN:       return "spin";
+            case RBWaitPolicy::WAIT_SPIN_YIELD: return "spin_yield";
+            case RBWaitPolicy::WAIT_ADAPTIVE:   return "adaptive";
+            default: return "unknown";
+        }
+    }
+
+    std::string getHugePagesString(RBHugePages pages) {
+        switch( pages ) {
+            case RBHugePages::HUGEPAGES_NONE:        return "none";
+            case RBHugePages::HUGEPAGES_TRANSPARENT: return "transparent";
+            case RBHugePages::HUGEPAGES_2MB:         return "2mb";
+            case RBHugePages::HUGEPAGES_1GB:         return "1gb";
+            default: return "unknown";
+        }
+    }
+
+    std::string getNumaPolicyString(RBNumaPolicy policy) {
+        switch( policy ) {
+            case RBNumaPolicy::NUMA_NONE:       return "none";
+            case RBNumaPolicy::NUMA_CORE:       return "core";
+            case RBNumaPolicy::NUMA_NODE:       return "node";
+            case RBNumaPolicy::NUMA_INTERLEAVE: return "interleave";
+            case RBNumaPolicy::NUMA_RINGLETS:   return "ringlets";
+            default: return "unknown";
+        }
+    }
+
     void requireSuccess(RBStatus status) {
         if( status != RBStatus ::STATUS_SUCCESS ) {
             throw RBException(status);
@@ -148,7 +184,34 @@ namespace ringbuffer {
     }
 
     bool getShmEnabled() {
-        return false; // for now ..
+#if defined __linux__ && __linux__
+        return true;
+#else
+        return false; // needs shm_open and futexes
+#endif
+    }
+
+    bool getProcLogEnabled() {
+#if defined __linux__ && __linux__
+        int enabled = g_proclog_enabled.load();
+        if( enabled < 0 ) {
+            const char* env = std::getenv("RINGBUFFER_PROCLOG");
+            enabled = (env && std::strcmp(env, "0") == 0) ? 0 : 1;
+            g_proclog_enabled.store(enabled);
+        }
+        return enabled != 0;
+#else
+        return false;
+#endif
+    }
+
+    RBStatus setProcLogEnabled(bool b) {
+#if defined __linux__ && __linux__
+        g_proclog_enabled.store(b ? 1 : 0);
+        return RBStatus::STATUS_SUCCESS;
+#else
+        return RBStatus::STATUS_INVALID_STATE;
+#endif
     }
 
 } // namespace ringbuffer
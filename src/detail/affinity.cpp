@@ -45,7 +45,7 @@
 
 
 /*
- * This part should use the hwloc library, maybe changing the interface to support logical cores and numa nodes
+ * Cores are OS cpu indices throughout, the topology comes from hwloc if available
 */
 #if defined __linux__ && __linux__
 #include <pthread.h>
@@ -54,6 +54,19 @@
 #endif
 #include <errno.h>
 
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+
+#ifdef RINGBUFFER_WITH_HWLOC
+#include <hwloc.h>
+#if HWLOC_API_VERSION < 0x00020000
+#error "RINGBUFFER_WITH_HWLOC requires hwloc 2.x"
+#endif
+#endif
+
 #ifdef RINGBUFFER_WITH_OMP
 #include <omp.h>
 #endif // RINGBUFFER_WITH_OMP
@@ -148,5 +161,199 @@ namespace ringbuffer {
 #endif
         }
 
+        RBStatus affinitySetCores(const std::vector<int>& cores) {
+#if defined __linux__ && __linux__
+            int ncore = sysconf(_SC_NPROCESSORS_ONLN);
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            for( int core : cores ) {
+                RB_ASSERT(core >= 0 && core < ncore, RBStatus::STATUS_INVALID_ARGUMENT);
+                CPU_SET(core, &cpuset);
+            }
+            if( cores.empty() ) {
+                for( int c=0; c<ncore; ++c ) {
+                    CPU_SET(c, &cpuset);
+                }
+            }
+            int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+            RB_ASSERT(ret == 0, RBStatus::STATUS_INVALID_ARGUMENT);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus affinityGetCores(std::vector<int>* cores) {
+            RB_ASSERT(cores, RBStatus::STATUS_INVALID_POINTER);
+#if defined __linux__ && __linux__
+            cpu_set_t cpuset;
+            RB_ASSERT(!pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset),
+                      RBStatus::STATUS_INTERNAL_ERROR);
+            cores->clear();
+            for( int c=0; c<CPU_SETSIZE; ++c ) {
+                if( CPU_ISSET(c, &cpuset) ) {
+                    cores->push_back(c);
+                }
+            }
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus affinitySetNumaNode(int node) {
+            std::vector<int> cores;
+            RB_ASSERT(topologyGetNumaNodeCores(node, &cores) == RBStatus::STATUS_SUCCESS, RBStatus::STATUS_INVALID_ARGUMENT);
+            RB_ASSERT(!cores.empty(), RBStatus::STATUS_INVALID_ARGUMENT);
+            return affinitySetCores(cores);
+        }
+
+        RBStatus affinitySetCacheDomain(int core, int level) {
+            std::vector<int> cores;
+            RB_ASSERT(topologyGetCacheCores(core, level, &cores) == RBStatus::STATUS_SUCCESS, RBStatus::STATUS_INVALID_ARGUMENT);
+            return affinitySetCores(cores);
+        }
+
+        namespace {
+#ifdef RINGBUFFER_WITH_HWLOC
+            // Note: Loaded once and leaked, the topology does not change while the process runs
+            hwloc_topology_t topology() {
+                static hwloc_topology_t topo = []() {
+                    hwloc_topology_t t = nullptr;
+                    if( hwloc_topology_init(&t) != 0 ) {
+                        return static_cast<hwloc_topology_t>(nullptr);
+                    }
+                    if( hwloc_topology_load(t) != 0 ) {
+                        hwloc_topology_destroy(t);
+                        return static_cast<hwloc_topology_t>(nullptr);
+                    }
+                    return t;
+                }();
+                return topo;
+            }
+
+            void cpuset_to_cores(hwloc_const_cpuset_t cpuset, std::vector<int>* cores) {
+                cores->clear();
+                unsigned int index;
+                hwloc_bitmap_foreach_begin(index, cpuset)
+                    cores->push_back(int(index));
+                hwloc_bitmap_foreach_end();
+            }
+#elif defined __linux__ && __linux__
+            // Parses a sysfs cpu list like "0-3,8,10-11"
+            bool read_cpu_list(const std::string& path, std::vector<int>* cores) {
+                std::ifstream file(path);
+                std::string list;
+                if( !(file >> list) ) {
+                    return false;
+                }
+                cores->clear();
+                std::stringstream ranges(list);
+                std::string range;
+                while( std::getline(ranges, range, ',') ) {
+                    auto dash = range.find('-');
+                    int first = std::stoi(range.substr(0, dash));
+                    int last  = dash == std::string::npos ? first : std::stoi(range.substr(dash+1));
+                    for( int c=first; c<=last; ++c ) {
+                        cores->push_back(c);
+                    }
+                }
+                return true;
+            }
+#endif
+        } // namespace
+
+        RBStatus topologyGetNumaNodeCores(int node, std::vector<int>* cores) {
+            RB_ASSERT(cores, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(node >= 0, RBStatus::STATUS_INVALID_ARGUMENT);
+#ifdef RINGBUFFER_WITH_HWLOC
+            hwloc_topology_t topo = topology();
+            RB_ASSERT(topo, RBStatus::STATUS_UNSUPPORTED);
+            hwloc_obj_t obj = hwloc_get_numanode_obj_by_os_index(topo, unsigned(node));
+            RB_ASSERT(obj, RBStatus::STATUS_INVALID_ARGUMENT);
+            cpuset_to_cores(obj->cpuset, cores);
+            return RBStatus::STATUS_SUCCESS;
+#elif defined __linux__ && __linux__
+            RB_ASSERT(read_cpu_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", cores),
+                      RBStatus::STATUS_INVALID_ARGUMENT);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus topologyGetCacheCores(int core, int level, std::vector<int>* cores) {
+            RB_ASSERT(cores, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(core >= 0 && level >= 1, RBStatus::STATUS_INVALID_ARGUMENT);
+#ifdef RINGBUFFER_WITH_HWLOC
+            hwloc_topology_t topo = topology();
+            RB_ASSERT(topo, RBStatus::STATUS_UNSUPPORTED);
+            hwloc_obj_t pu = hwloc_get_pu_obj_by_os_index(topo, unsigned(core));
+            RB_ASSERT(pu, RBStatus::STATUS_INVALID_ARGUMENT);
+            for( hwloc_obj_t obj=pu->parent; obj; obj=obj->parent ) {
+                if( hwloc_obj_type_is_dcache(obj->type) && int(obj->attr->cache.depth) == level ) {
+                    cpuset_to_cores(obj->cpuset, cores);
+                    return RBStatus::STATUS_SUCCESS;
+                }
+            }
+            // No cache of this level
+            return RBStatus::STATUS_INVALID_ARGUMENT;
+#elif defined __linux__ && __linux__
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(core) + "/cache/index";
+            for( int index=0; ; ++index ) {
+                std::ifstream level_file(base + std::to_string(index) + "/level");
+                int cache_level = 0;
+                if( !(level_file >> cache_level) ) {
+                    // No cache of this level
+                    return RBStatus::STATUS_INVALID_ARGUMENT;
+                }
+                std::ifstream type_file(base + std::to_string(index) + "/type");
+                std::string type;
+                type_file >> type;
+                if( cache_level == level && type != "Instruction" ) {
+                    RB_ASSERT(read_cpu_list(base + std::to_string(index) + "/shared_cpu_list", cores),
+                              RBStatus::STATUS_INTERNAL_ERROR);
+                    return RBStatus::STATUS_SUCCESS;
+                }
+            }
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus topologyGetCacheDomains(int level, std::vector<std::vector<int>>* domains) {
+            RB_ASSERT(domains, RBStatus::STATUS_INVALID_POINTER);
+#if defined __linux__ && __linux__
+            int ncore = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+            int ncore = 0;
+#endif
+            std::set<std::vector<int>> unique;
+            for( int c=0; c<ncore; ++c ) {
+                std::vector<int> cores;
+                RBStatus status = topologyGetCacheCores(c, level, &cores);
+                RB_ASSERT(status == RBStatus::STATUS_SUCCESS, status);
+                unique.insert(cores);
+            }
+            RB_ASSERT(!unique.empty(), RBStatus::STATUS_UNSUPPORTED);
+            domains->assign(unique.begin(), unique.end());
+            return RBStatus::STATUS_SUCCESS;
+        }
+
+        RBStatus topologyPlaceOnCache(int core, int level, std::size_t ncore, std::vector<int>* cores) {
+            RB_ASSERT(cores, RBStatus::STATUS_INVALID_POINTER);
+            std::vector<int> domain;
+            RBStatus status = topologyGetCacheCores(core, level, &domain);
+            RB_ASSERT(status == RBStatus::STATUS_SUCCESS, status);
+            // Start at core and wrap around the domain, so threads get distinct cores while possible
+            auto it = std::find(domain.begin(), domain.end(), core);
+            std::rotate(domain.begin(), it != domain.end() ? it : domain.begin(), domain.end());
+            cores->resize(ncore);
+            for( std::size_t i=0; i<ncore; ++i ) {
+                (*cores)[i] = domain[i % domain.size()];
+            }
+            return RBStatus::STATUS_SUCCESS;
+        }
+
     }
 }
\ No newline at end of file
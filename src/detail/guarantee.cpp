@@ -50,18 +50,18 @@ namespace ringbuffer {
         void Guarantee::create(std::size_t offset) {
             m_offset = offset;
             if (m_ring) {
-                m_ring->_add_guarantee(m_offset);
+                m_offset = m_ring->_add_guarantee(m_offset, &m_slot);
             }
         }
 
         void Guarantee::destroy() {
             if (m_ring) {
-                m_ring->_remove_guarantee(m_offset);
+                m_ring->_remove_guarantee(m_slot);
             }
         }
 
         Guarantee::Guarantee(const std::shared_ptr<Ring>& ring)
-                : m_ring(ring), m_offset(0) {
+                : m_ring(ring), m_offset(0), m_slot(-1) {
             if (m_ring) {
                 auto& state = m_ring->get_state();
                 state::lock_guard_type lock(state.mutex);
@@ -81,8 +81,11 @@ namespace ringbuffer {
 		Guarantee& Guarantee::operator=(Guarantee&&) = default;
 
         void Guarantee::move_nolock(std::size_t offset) {
-            this->destroy();
-            this->create(offset);
+            if (m_ring) {
+                m_offset = m_ring->_move_guarantee(m_slot, offset);
+            } else {
+                m_offset = offset;
+            }
         }
 
         std::size_t Guarantee::offset() const { return m_offset; }
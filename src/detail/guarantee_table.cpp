@@ -0,0 +1,101 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#include "ringbuffer/detail/guarantee_table.h"
+
+namespace ringbuffer {
+    namespace state {
+
+        void GuaranteeTable::_lower_earliest(std::size_t offset) {
+            // Note: Offsets wrap, so 'earlier' has to be decided by the signed distance
+            std::size_t cur = earliest.load();
+            while( (count.load() == 0 || delta_type(offset - cur) < 0) &&
+                   !earliest.compare_exchange_weak(cur, offset) ) {}
+        }
+
+        int GuaranteeTable::add(std::size_t offset) {
+            for( int i=0; i<RINGBUFFER_MAX_GUARANTEES; ++i ) {
+                if( !slots[i].active.load() ) {
+                    slots[i].offset.store(offset);
+                    slots[i].active.store(true);
+                    this->_lower_earliest(offset);
+                    // Note: The count is published last, so a writer that sees it
+                    //         also sees the lowered bound.
+                    ++count;
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        void GuaranteeTable::remove(int slot) {
+            // Note: The cached bound stays valid, it just becomes more conservative
+            slots[slot].active.store(false);
+            --count;
+        }
+
+        void GuaranteeTable::move_back(int slot, std::size_t offset) {
+            slots[slot].offset.store(offset);
+            this->_lower_earliest(offset);
+        }
+
+        std::size_t GuaranteeTable::recompute_earliest(std::size_t reference) {
+            // The earliest cursor is the one furthest behind the reference offset,
+            //   cursors ahead of it (readers waiting for data) do not hold anything back
+            std::size_t result = reference;
+            delta_type max_distance = 0;
+            for( auto& slot : slots ) {
+                if( slot.active.load() ) {
+                    std::size_t offset = slot.offset.load();
+                    if( delta_type(reference - offset) > max_distance ) {
+                        max_distance = delta_type(reference - offset);
+                        result = offset;
+                    }
+                }
+            }
+            earliest.store(result);
+            return result;
+        }
+
+    }
+}
@@ -0,0 +1,173 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#include "ringbuffer/detail/histogram.h"
+
+#include <algorithm>
+
+namespace ringbuffer {
+    namespace state {
+
+        namespace {
+            int shard_index() {
+                static std::atomic<unsigned> next_shard{0};
+                thread_local int shard = int(next_shard.fetch_add(1) % RINGBUFFER_HISTOGRAM_SHARDS);
+                return shard;
+            }
+
+            int log2_floor(std::uint64_t value) {
+                int bits = 0;
+                while( value >>= 1 ) {
+                    ++bits;
+                }
+                return bits;
+            }
+        }
+
+        int LatencyHistogram::bucket_of(std::uint64_t ns) {
+            if( ns < std::uint64_t(SUB_BUCKETS) ) {
+                return int(ns);
+            }
+            int octave = log2_floor(ns);
+            int sub    = int((ns >> (octave - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+            return (octave - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+        }
+
+        std::uint64_t LatencyHistogram::bucket_upper(int bucket) {
+            if( bucket < SUB_BUCKETS ) {
+                return std::uint64_t(bucket);
+            }
+            int octave = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+            int sub    = bucket % SUB_BUCKETS;
+            int shift  = octave - SUB_BUCKET_BITS;
+            if( octave >= 63 && sub == SUB_BUCKETS - 1 ) {
+                return ~std::uint64_t(0);
+            }
+            return ((std::uint64_t(SUB_BUCKETS + sub + 1)) << shift) - 1;
+        }
+
+        void LatencyHistogram::record(std::uint64_t ns) {
+            auto& shard = m_shards[shard_index()];
+            shard.buckets[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+            std::uint64_t max = shard.max.load(std::memory_order_relaxed);
+            while( ns > max && !shard.max.compare_exchange_weak(max, ns, std::memory_order_relaxed) ) {}
+        }
+
+        LatencySummary LatencyHistogram::summary() const {
+            std::uint64_t counts[BUCKETS] = {};
+            LatencySummary summary;
+            std::uint64_t max = 0;
+            for( const auto& shard : m_shards ) {
+                for( int b = 0; b < BUCKETS; ++b ) {
+                    counts[b] += shard.buckets[b].load(std::memory_order_relaxed);
+                }
+                max = std::max(max, shard.max.load(std::memory_order_relaxed));
+            }
+            for( int b = 0; b < BUCKETS; ++b ) {
+                summary.count += counts[b];
+            }
+            if( summary.count == 0 ) {
+                return summary;
+            }
+            auto percentile = [&](double p) {
+                // Note: Rank of the value below which a fraction p of all samples lies
+                std::uint64_t rank = std::max<std::uint64_t>(1, std::uint64_t(p * double(summary.count) + 0.5));
+                std::uint64_t seen = 0;
+                for( int b = 0; b < BUCKETS; ++b ) {
+                    seen += counts[b];
+                    if( seen >= rank ) {
+                        return std::chrono::nanoseconds(std::min(bucket_upper(b), max));
+                    }
+                }
+                return std::chrono::nanoseconds(max);
+            };
+            summary.p50  = percentile(0.5);
+            summary.p99  = percentile(0.99);
+            summary.p999 = percentile(0.999);
+            summary.max  = std::chrono::nanoseconds(max);
+            return summary;
+        }
+
+        void CommitTimes::record(std::size_t end, std::chrono::steady_clock::time_point time) {
+            std::uint64_t index = m_count.load(std::memory_order_relaxed);
+            auto& entry = m_entries[index % RINGBUFFER_COMMIT_TIMES];
+            // Note: end is invalidated first, so readers never pair a new time with an old end
+            entry.end.store(0, std::memory_order_relaxed);
+            entry.time.store(time.time_since_epoch().count(), std::memory_order_release);
+            entry.end.store(end, std::memory_order_release);
+            m_count.store(index + 1, std::memory_order_release);
+        }
+
+        bool CommitTimes::lookup(std::size_t end, std::chrono::steady_clock::time_point* time) const {
+            std::uint64_t count = m_count.load(std::memory_order_acquire);
+            std::uint64_t first = count > RINGBUFFER_COMMIT_TIMES ? count - RINGBUFFER_COMMIT_TIMES : 0;
+            // Walk back from the newest commit to the oldest one that still covers end,
+            //   that is the commit which made the data available
+            std::int64_t found_time = 0;
+            bool found = false;
+            for( std::uint64_t i = count; i > first; --i ) {
+                const auto& entry = m_entries[(i - 1) % RINGBUFFER_COMMIT_TIMES];
+                std::size_t   entry_end  = entry.end.load(std::memory_order_acquire);
+                std::int64_t  entry_time = entry.time.load(std::memory_order_acquire);
+                if( entry_end == 0 || entry.end.load(std::memory_order_acquire) != entry_end ) {
+                    // being overwritten by the writer
+                    return false;
+                }
+                if( delta_type(entry_end - end) < 0 ) {
+                    break;
+                }
+                found_time = entry_time;
+                found = true;
+                if( i - 1 == first && first != 0 ) {
+                    // older commits are gone, so this might not be the one that covered end
+                    return false;
+                }
+            }
+            if( found ) {
+                *time = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(found_time));
+            }
+            return found;
+        }
+
+    }
+}
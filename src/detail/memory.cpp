@@ -42,11 +42,38 @@
 *************************************************************************************/
 
 #include "ringbuffer/detail/memory.h"
+#include "ringbuffer/detail/thread_pool.h"
 #include "ringbuffer/detail/cuda.h"
 #include "ringbuffer/detail/trace.h"
 
+#include "ringbuffer/detail/util.h"
+
+#include <atomic>
 #include <cstdlib> // For posix_memalign
 #include <cstring> // For memcpy
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined __GNUC__ && defined __x86_64__
+#include <immintrin.h> // For streaming stores
+#endif
+
+#ifdef RINGBUFFER_WITH_NUMA
+#include <numa.h>
+#include <numaif.h> // For mbind, get_mempolicy
+#endif
+
+#if defined __linux__ && __linux__
+#include <sys/mman.h> // For mmap, memfd_create
+#include <unistd.h>   // For ftruncate, sysconf
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#endif
 
 namespace ringbuffer {
     namespace memory {
@@ -184,9 +211,11 @@ namespace ringbuffer {
                 if( dst_space == RBSpace::SPACE_AUTO ) memory::getSpace(dst, &dst_space);
                 cudaMemcpyKind kind = cudaMemcpyDefault;
                 switch( src_space ) {
+                    case RBSpace::SPACE_SHM: // fall-through
                     case RBSpace::SPACE_CUDA_HOST: // fall-through
                     case RBSpace::SPACE_SYSTEM: {
                         switch( dst_space ) {
+                            case RBSpace::SPACE_SHM: // fall-through
                             case RBSpace::SPACE_CUDA_HOST: // fall-through
                             case RBSpace::SPACE_SYSTEM:
                                 ::memcpy(dst, src, count);
@@ -196,13 +225,13 @@ namespace ringbuffer {
                                 break;
 
                                 // @todo: RBSpace::SPACE_CUDA_MANAGED
-                                // @todo: RBSpace::SPACE_SHM
                             default: RB_FAIL("Valid memcpy_ dst space", RBStatus::STATUS_INVALID_ARGUMENT);
                         }
                         break;
                     }
                     case RBSpace::SPACE_CUDA: {
                         switch( dst_space ) {
+                            case RBSpace::SPACE_SHM: // fall-through
                             case RBSpace::SPACE_CUDA_HOST: // fall-through
                             case RBSpace::SPACE_SYSTEM:
                                 kind = cudaMemcpyDeviceToHost;
@@ -211,12 +240,10 @@ namespace ringbuffer {
                                 kind = cudaMemcpyDeviceToDevice;
                                 break;
                                 // @todo: RBSpace::SPACE_CUDA_MANAGED
-                                // @todo: RBSpace::SPACE_SHM
                             default: RB_FAIL("Valid memcpy_ dst space", RBStatus::STATUS_INVALID_ARGUMENT);
                         }
                         break;
                     }
-                        // @todo: RBSpace::SPACE_SHM
                     default: RB_FAIL("Valid memcpy_ src space", RBStatus::STATUS_INVALID_ARGUMENT);
                 }
                 RB_TRACE_STREAM(cuda::g_cuda_stream);
@@ -227,6 +254,86 @@ namespace ringbuffer {
             return RBStatus::STATUS_SUCCESS;
         }
 
+        namespace {
+            std::mutex                                                   g_pool_mutex;
+            std::map<std::vector<int>, std::shared_ptr<util::ThreadPool>> g_pools;
+
+            std::vector<int> pool_cores(std::size_t nworker, const int* thread_cores) {
+                std::vector<int> cores(nworker, -1);
+                if( thread_cores ) {
+                    cores.assign(thread_cores, thread_cores + nworker);
+                }
+                return cores;
+            }
+
+            // Pooled threads for nworker workers pinned to thread_cores (may be null, -1 does
+            //   not pin), created on first use and kept for later calls with the same cores
+            std::shared_ptr<util::ThreadPool> get_pool(std::size_t nworker, const int* thread_cores) {
+                std::vector<int> cores = pool_cores(nworker, thread_cores);
+                std::lock_guard<std::mutex> lock(g_pool_mutex);
+                auto& pool = g_pools[cores];
+                if( !pool ) {
+                    pool = std::make_shared<util::ThreadPool>(nworker, cores);
+                }
+                return pool;
+            }
+
+            // Runs fn(t) for t in [0, nthread), part t on a pooled thread pinned to thread_cores[t].
+            //   If caller_runs, the last part runs on the calling thread and, while the pool is
+            //   busy with another call, the calling thread does all parts. Otherwise every part
+            //   runs pinned, on threads of its own while the pool is busy.
+            template<typename Func>
+            void run_pooled(std::size_t nthread, const int* thread_cores, bool caller_runs, Func&& fn) {
+                std::size_t nworker = caller_runs ? nthread - 1 : nthread;
+                if( nworker ) {
+                    std::function<void(std::size_t)> job = [&](std::size_t t) { fn(t); };
+                    if( get_pool(nworker, thread_cores)->try_run(job, caller_runs) ) {
+                        return;
+                    }
+                    if( !caller_runs ) {
+                        util::ThreadPool(nworker, pool_cores(nworker, thread_cores)).try_run(job, false);
+                        return;
+                    }
+                }
+                for( std::size_t t=0; t<nthread; ++t ) {
+                    fn(t);
+                }
+            }
+
+            // Calls fn(row_beg, nrow, col_beg, ncol) with part t of nthread parts of a 2D array,
+            //   rows are split if there are enough of them, page aligned column ranges otherwise
+            template<typename Func>
+            void for_part_2d(std::size_t t, std::size_t nthread, std::size_t width, std::size_t height, Func&& fn) {
+                if( height >= nthread ) {
+                    std::size_t rows = util::div_round_up(height, nthread);
+                    std::size_t beg  = std::min(t*rows, height);
+                    fn(beg, std::min(beg+rows, height) - beg, std::size_t(0), width);
+                } else {
+                    std::size_t cols = util::round_up(util::div_round_up(width, nthread), getPageSize());
+                    std::size_t beg  = std::min(t*cols, width);
+                    fn(std::size_t(0), height, beg, std::min(beg+cols, width) - beg);
+                }
+            }
+
+            void copy_rows(void*       dst,
+                           std::size_t dst_stride,
+                           const void* src,
+                           std::size_t src_stride,
+                           std::size_t width,
+                           std::size_t height) {
+                if( width == dst_stride && width == src_stride ) {
+                    // Contiguous rows, one large copy is faster than many small ones
+                    ::memcpy(dst, src, width*height);
+                    return;
+                }
+                for( std::size_t row=0; row<height; ++row ) {
+                    ::memcpy((char*)dst + row*dst_stride,
+                             (char*)src + row*src_stride,
+                             width);
+                }
+            }
+        } // namespace
+
         void memcpy2D(void*       dst,
                       std::size_t dst_stride,
                       const void* src,
@@ -235,11 +342,7 @@ namespace ringbuffer {
                       std::size_t height) {
 //    spdlog::trace("memcpy2D dst: {0}, dst_stride: {1}, src: {2}, src_stride: {4}, width: {5}, height: {6}",
 //            dst, dst_stride, src, src_stride, width, height);
-            for( std::size_t row=0; row<height; ++row ) {
-                ::memcpy((char*)dst + row*dst_stride,
-                         (char*)src + row*src_stride,
-                         width);
-            }
+            copy_rows(dst, dst_stride, src, src_stride, width, height);
         }
 
 
@@ -263,9 +366,11 @@ namespace ringbuffer {
                 if( dst_space == RBSpace::SPACE_AUTO ) memory::getSpace(dst, &dst_space);
                 cudaMemcpyKind kind = cudaMemcpyDefault;
                 switch( src_space ) {
+                    case RBSpace::SPACE_SHM: // fall-through
                     case RBSpace::SPACE_CUDA_HOST: // fall-through
                     case RBSpace::SPACE_SYSTEM: {
                         switch( dst_space ) {
+                            case RBSpace::SPACE_SHM: // fall-through
                             case RBSpace::SPACE_CUDA_HOST: // fall-through
                             case RBSpace::SPACE_SYSTEM:
                                 memcpy2D(dst, dst_stride, src, src_stride, width, height);
@@ -284,6 +389,7 @@ namespace ringbuffer {
                     }
                     case RBSpace::SPACE_CUDA: {
                         switch( dst_space ) {
+                            case RBSpace::SPACE_SHM: // fall-through
                             case RBSpace::SPACE_CUDA_HOST: // fall-through
                             case RBSpace::SPACE_SYSTEM:
                                 kind = cudaMemcpyDeviceToHost;
@@ -325,6 +431,7 @@ namespace ringbuffer {
                     memory::getSpace(ptr, &space);
                 }
                 switch( space ) {
+                    case RBSpace::SPACE_SHM: // fall-through
                     case RBSpace::SPACE_SYSTEM:
                         ::memset(ptr, value, count);
                         break;
@@ -347,14 +454,28 @@ namespace ringbuffer {
             return RBStatus::STATUS_SUCCESS;
         }
 
+        namespace {
+            void set_rows(void*  ptr,
+                          std::size_t stride,
+                          int    value,
+                          std::size_t width,
+                          std::size_t height) {
+                if( width == stride ) {
+                    ::memset(ptr, value, width*height);
+                    return;
+                }
+                for( std::size_t row=0; row<height; ++row ) {
+                    ::memset((char*)ptr + row*stride, value, width);
+                }
+            }
+        } // namespace
+
         void memset2D(void*  ptr,
                       std::size_t stride,
                       int    value,
                       std::size_t width,
                       std::size_t height) {
-            for( std::size_t row=0; row<height; ++row ) {
-                ::memset((char*)ptr + row*stride, value, width);
-            }
+            set_rows(ptr, stride, value, width, height);
         }
 
         RBStatus memset2D(void*   ptr,
@@ -369,6 +490,7 @@ namespace ringbuffer {
                     memory::getSpace(ptr, &space);
                 }
                 switch( space ) {
+                    case RBSpace::SPACE_SHM: // fall-through
                     case RBSpace::SPACE_SYSTEM:
                         memset2D(ptr, stride, value, width, height);
                         break;
@@ -395,6 +517,617 @@ namespace ringbuffer {
             return RINGBUFFER_ALIGNMENT;
         }
 
+        std::size_t getPageSize() {
+#if defined __linux__ && __linux__
+            return std::size_t(::sysconf(_SC_PAGESIZE));
+#else
+            return 4096;
+#endif
+        }
+
+        RBStatus mapMirrored(void** ptr, int fd, std::size_t offset, std::size_t size, std::size_t nmirror) {
+            RB_ASSERT(ptr, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(size && nmirror, RBStatus::STATUS_INVALID_ARGUMENT);
+            RB_ASSERT(size % getPageSize() == 0 && offset % getPageSize() == 0, RBStatus::STATUS_INVALID_ARGUMENT);
+#if defined __linux__ && __linux__
+            // Reserve the address range first, then map each region twice into it
+            auto* base = (uint8_t*)::mmap(nullptr, 2*size*nmirror, PROT_NONE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            RB_ASSERT(base != MAP_FAILED, RBStatus::STATUS_MEM_ALLOC_FAILED);
+            for( std::size_t i=0; i<2*nmirror; ++i ) {
+                void* addr = ::mmap(base + i*size, size, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_FIXED, fd, off_t(offset + (i/2)*size));
+                if( addr == MAP_FAILED ) {
+                    ::munmap(base, 2*size*nmirror);
+                    RB_FAIL("map mirrored region", RBStatus::STATUS_MEM_ALLOC_FAILED);
+                }
+            }
+            *ptr = base;
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus mallocMirrored(void** ptr, std::size_t size, std::size_t nmirror) {
+            RB_ASSERT(ptr, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(size && nmirror, RBStatus::STATUS_INVALID_ARGUMENT);
+#if defined __linux__ && __linux__
+            int fd = ::memfd_create("ringbuffer", MFD_CLOEXEC);
+            RB_ASSERT(fd != -1, RBStatus::STATUS_MEM_ALLOC_FAILED);
+            if( ::ftruncate(fd, off_t(size*nmirror)) != 0 ) {
+                ::close(fd);
+                RB_FAIL("ftruncate mirrored memory", RBStatus::STATUS_MEM_ALLOC_FAILED);
+            }
+            RBStatus status = mapMirrored(ptr, fd, 0, size, nmirror);
+            // The mappings keep the memory alive
+            ::close(fd);
+            return status;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus freeMirrored(void* ptr, std::size_t size, std::size_t nmirror) {
+            RB_ASSERT(ptr, RBStatus::STATUS_INVALID_POINTER);
+#if defined __linux__ && __linux__
+            RB_ASSERT(::munmap(ptr, 2*size*nmirror) == 0, RBStatus::STATUS_INVALID_ARGUMENT);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        namespace {
+            std::atomic<RBHugePages> g_default_hugepages{RBHugePages::HUGEPAGES_NONE};
+
+            std::size_t transparent_hugepage_size() {
+                // Note: Usually the PMD size (2MB on x86-64 and 4K-page arm64)
+                static const std::size_t size = []() {
+                    std::size_t value = 0;
+                    std::ifstream file("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+                    if( !(file >> value) || value == 0 ) {
+                        value = std::size_t(2) << 20;
+                    }
+                    return value;
+                }();
+                return size;
+            }
+
+#if defined __linux__ && __linux__
+            void* map_transparent(std::size_t size, std::size_t page) {
+                // Over-allocate and trim, so that the mapping is aligned to the huge page size
+                auto* base = (uint8_t*)::mmap(nullptr, size + page, PROT_READ | PROT_WRITE,
+                                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if( base == MAP_FAILED ) {
+                    return nullptr;
+                }
+                auto* aligned = (uint8_t*)util::round_up(std::size_t(base), page);
+                if( aligned != base ) {
+                    ::munmap(base, std::size_t(aligned - base));
+                }
+                std::size_t tail = std::size_t(base + size + page - (aligned + size));
+                if( tail ) {
+                    ::munmap(aligned + size, tail);
+                }
+                // Note: Only a hint, the kernel may still use small pages (e.g. THP disabled)
+                ::madvise(aligned, size, MADV_HUGEPAGE);
+                return aligned;
+            }
+#endif
+        }
+
+        std::size_t getHugePageSize(RBHugePages pages) {
+            switch( pages ) {
+                case RBHugePages::HUGEPAGES_TRANSPARENT: return transparent_hugepage_size();
+                case RBHugePages::HUGEPAGES_2MB:         return std::size_t(1) << 21;
+                case RBHugePages::HUGEPAGES_1GB:         return std::size_t(1) << 30;
+                default:                                 return getPageSize();
+            }
+        }
+
+        RBStatus mallocHuge(void** ptr, std::size_t size, RBHugePages pages, RBHugePages* used) {
+            RB_ASSERT(ptr, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(size, RBStatus::STATUS_INVALID_ARGUMENT);
+            if( pages == RBHugePages::HUGEPAGES_NONE ) {
+                if( used ) {
+                    *used = pages;
+                }
+                return malloc_(ptr, size, RBSpace::SPACE_SYSTEM);
+            }
+#if defined __linux__ && __linux__
+            // Explicit huge pages, from the largest requested size down
+            for( RBHugePages explicit_pages : {RBHugePages::HUGEPAGES_1GB, RBHugePages::HUGEPAGES_2MB} ) {
+                if( int(explicit_pages) > int(pages) ) {
+                    continue;
+                }
+                std::size_t page = getHugePageSize(explicit_pages);
+                int log2_page = (explicit_pages == RBHugePages::HUGEPAGES_1GB ? 30 : 21);
+                void* data = ::mmap(nullptr, util::round_up(size, page), PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2_page << MAP_HUGE_SHIFT), -1, 0);
+                if( data != MAP_FAILED ) {
+                    *ptr = data;
+                    if( used ) {
+                        *used = explicit_pages;
+                    }
+                    return RBStatus::STATUS_SUCCESS;
+                }
+            }
+            std::size_t page = transparent_hugepage_size();
+            void* data = map_transparent(util::round_up(size, page), page);
+            RB_ASSERT(data, RBStatus::STATUS_MEM_ALLOC_FAILED);
+            *ptr = data;
+            if( used ) {
+                *used = RBHugePages::HUGEPAGES_TRANSPARENT;
+            }
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus freeHuge(void* ptr, std::size_t size, RBHugePages used) {
+            RB_ASSERT(ptr, RBStatus::STATUS_INVALID_POINTER);
+            if( used == RBHugePages::HUGEPAGES_NONE ) {
+                return free_(ptr, RBSpace::SPACE_SYSTEM);
+            }
+#if defined __linux__ && __linux__
+            RB_ASSERT(::munmap(ptr, util::round_up(size, getHugePageSize(used))) == 0, RBStatus::STATUS_INVALID_ARGUMENT);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        void setDefaultHugePages(RBHugePages pages) {
+            g_default_hugepages.store(pages);
+        }
+
+        RBHugePages getDefaultHugePages() {
+            return g_default_hugepages.load();
+        }
+
+        namespace {
+            void touch_pages(void* ptr, std::size_t size, std::size_t page_size) {
+                volatile uint8_t* buf = static_cast<uint8_t*>(ptr);
+                for( std::size_t offset=0; offset<size; offset+=page_size ) {
+                    buf[offset] = 0;
+                }
+                if( size ) {
+                    buf[size-1] = 0;
+                }
+            }
+        } // namespace
+
+        namespace {
+#if defined __GNUC__ && defined __x86_64__
+            // Copy n bytes with streaming (non-temporal) stores that bypass the caches.
+            //   The head up to the first vector aligned dst byte and the tail use memcpy.
+            __attribute__((target("avx512f")))
+            void stream_copy_avx512(char* dst, const char* src, std::size_t n) {
+                std::size_t head = std::min(n, std::size_t(-reinterpret_cast<std::uintptr_t>(dst) & 63));
+                ::memcpy(dst, src, head);
+                dst += head; src += head; n -= head;
+                for( ; n>=128; n-=128, dst+=128, src+=128 ) {
+                    __m512i a = _mm512_loadu_si512(src);
+                    __m512i b = _mm512_loadu_si512(src + 64);
+                    _mm512_stream_si512(reinterpret_cast<__m512i*>(dst), a);
+                    _mm512_stream_si512(reinterpret_cast<__m512i*>(dst + 64), b);
+                }
+                for( ; n>=64; n-=64, dst+=64, src+=64 ) {
+                    _mm512_stream_si512(reinterpret_cast<__m512i*>(dst), _mm512_loadu_si512(src));
+                }
+                ::memcpy(dst, src, n);
+            }
+
+            __attribute__((target("avx2")))
+            void stream_copy_avx2(char* dst, const char* src, std::size_t n) {
+                std::size_t head = std::min(n, std::size_t(-reinterpret_cast<std::uintptr_t>(dst) & 31));
+                ::memcpy(dst, src, head);
+                dst += head; src += head; n -= head;
+                for( ; n>=64; n-=64, dst+=64, src+=64 ) {
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+                    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+                    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), a);
+                    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), b);
+                }
+                for( ; n>=32; n-=32, dst+=32, src+=32 ) {
+                    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+                }
+                ::memcpy(dst, src, n);
+            }
+
+            void stream_copy_sse2(char* dst, const char* src, std::size_t n) {
+                std::size_t head = std::min(n, std::size_t(-reinterpret_cast<std::uintptr_t>(dst) & 15));
+                ::memcpy(dst, src, head);
+                dst += head; src += head; n -= head;
+                for( ; n>=16; n-=16, dst+=16, src+=16 ) {
+                    _mm_stream_si128(reinterpret_cast<__m128i*>(dst),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+                }
+                ::memcpy(dst, src, n);
+            }
+
+            typedef void (*stream_copy_type)(char*, const char*, std::size_t);
+
+            // Note: Resolved once, the widest instruction set the cpu supports
+            stream_copy_type stream_copy_impl() {
+                static const stream_copy_type impl = []() {
+                    __builtin_cpu_init();
+                    if( __builtin_cpu_supports("avx512f") ) {
+                        return &stream_copy_avx512;
+                    }
+                    if( __builtin_cpu_supports("avx2") ) {
+                        return &stream_copy_avx2;
+                    }
+                    return &stream_copy_sse2;
+                }();
+                return impl;
+            }
+#endif
+
+            void stream_copy_2d(void*       dst,
+                                std::size_t dst_stride,
+                                const void* src,
+                                std::size_t src_stride,
+                                std::size_t width,
+                                std::size_t height) {
+#if defined __GNUC__ && defined __x86_64__
+                if( width == dst_stride && width == src_stride ) {
+                    width *= height;
+                    height = 1;
+                }
+                stream_copy_type copy = stream_copy_impl();
+                for( std::size_t row=0; row<height; ++row ) {
+                    copy((char*)dst + row*dst_stride, (const char*)src + row*src_stride, width);
+                }
+                // Streaming stores are weakly ordered, publish them before returning
+                _mm_sfence();
+#else
+                copy_rows(dst, dst_stride, src, src_stride, width, height);
+#endif
+            }
+        } // namespace
+
+        RBStatus memcpy2DNonTemporal(void*       dst,
+                                     std::size_t dst_stride,
+                                     const void* src,
+                                     std::size_t src_stride,
+                                     std::size_t width,
+                                     std::size_t height) {
+            if( !width || !height ) {
+                return RBStatus::STATUS_SUCCESS;
+            }
+            RB_ASSERT(dst, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(src, RBStatus::STATUS_INVALID_POINTER);
+            if( width*height < RINGBUFFER_NONTEMPORAL_THRESHOLD ) {
+                // Small copies are likely to stay in the cache anyway
+                memcpy2D(dst, dst_stride, src, src_stride, width, height);
+                return RBStatus::STATUS_SUCCESS;
+            }
+            stream_copy_2d(dst, dst_stride, src, src_stride, width, height);
+            return RBStatus::STATUS_SUCCESS;
+        }
+
+        RBStatus prefault(void* ptr, std::size_t size, int core) {
+            RB_ASSERT(ptr || !size, RBStatus::STATUS_INVALID_POINTER);
+            if( core == -1 ) {
+                touch_pages(ptr, size, getPageSize());
+                return RBStatus::STATUS_SUCCESS;
+            }
+            // The kernel places each page on the node of the cpu that faults it in
+            return prefaultParallel(ptr, size, 1, &core);
+        }
+
+        RBStatus prefaultParallel(void* ptr, std::size_t size, std::size_t nthread, const int* thread_cores) {
+            RB_ASSERT(ptr || !size, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(nthread > 0, RBStatus::STATUS_INVALID_ARGUMENT);
+            std::size_t page_size = getPageSize();
+            if( size < RINGBUFFER_PARALLEL_COPY_THRESHOLD ) {
+                // Not worth waking more than one thread, but the pages still go to its node
+                nthread = 1;
+                if( !thread_cores || thread_cores[0] == -1 ) {
+                    touch_pages(ptr, size, page_size);
+                    return RBStatus::STATUS_SUCCESS;
+                }
+            }
+            // Whole pages per thread, so no page is faulted in by two threads
+            std::size_t chunk = util::round_up(util::div_round_up(size, nthread), page_size);
+            // Note: The calling thread takes no part, the pages belong to the pinned threads' nodes
+            run_pooled(nthread, thread_cores, false, [&](std::size_t t) {
+                std::size_t beg = std::min(t*chunk, size);
+                std::size_t end = std::min(beg+chunk, size);
+                touch_pages(static_cast<uint8_t*>(ptr) + beg, end - beg, page_size);
+            });
+            return RBStatus::STATUS_SUCCESS;
+        }
+
+        RBStatus memcpy2DParallel(void*       dst,
+                                  std::size_t dst_stride,
+                                  const void* src,
+                                  std::size_t src_stride,
+                                  std::size_t width,
+                                  std::size_t height,
+                                  std::size_t nthread,
+                                  const int*  thread_cores,
+                                  bool        nontemporal) {
+            RB_ASSERT(nthread > 0, RBStatus::STATUS_INVALID_ARGUMENT);
+            if( !width || !height ) {
+                return RBStatus::STATUS_SUCCESS;
+            }
+            RB_ASSERT(dst, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(src, RBStatus::STATUS_INVALID_POINTER);
+            if( width*height < RINGBUFFER_PARALLEL_COPY_THRESHOLD ) {
+                // Small copies are not worth waking the pooled threads
+                if( nontemporal ) {
+                    return memcpy2DNonTemporal(dst, dst_stride, src, src_stride, width, height);
+                }
+                memcpy2D(dst, dst_stride, src, src_stride, width, height);
+                return RBStatus::STATUS_SUCCESS;
+            }
+            void (*copy2D)(void*, std::size_t, const void*, std::size_t, std::size_t, std::size_t) = copy_rows;
+            if( nontemporal && width*height >= RINGBUFFER_NONTEMPORAL_THRESHOLD ) {
+                copy2D = stream_copy_2d;
+            }
+            if( width == dst_stride && width == src_stride ) {
+                width *= height;
+                height = 1;
+                dst_stride = src_stride = width;
+            }
+            run_pooled(nthread, thread_cores, true, [&](std::size_t t) {
+                for_part_2d(t, nthread, width, height, [&](std::size_t row, std::size_t nrow,
+                                                           std::size_t col, std::size_t ncol) {
+                    copy2D((char*)dst + row*dst_stride + col, dst_stride,
+                           (const char*)src + row*src_stride + col, src_stride, ncol, nrow);
+                });
+            });
+            return RBStatus::STATUS_SUCCESS;
+        }
+
+        RBStatus memset2DParallel(void*       ptr,
+                                  std::size_t stride,
+                                  int         value,
+                                  std::size_t width,
+                                  std::size_t height,
+                                  std::size_t nthread,
+                                  const int*  thread_cores) {
+            RB_ASSERT(nthread > 0, RBStatus::STATUS_INVALID_ARGUMENT);
+            if( !width || !height ) {
+                return RBStatus::STATUS_SUCCESS;
+            }
+            RB_ASSERT(ptr, RBStatus::STATUS_INVALID_POINTER);
+            if( width*height < RINGBUFFER_PARALLEL_COPY_THRESHOLD ) {
+                memset2D(ptr, stride, value, width, height);
+                return RBStatus::STATUS_SUCCESS;
+            }
+            if( width == stride ) {
+                width *= height;
+                height = 1;
+                stride = width;
+            }
+            run_pooled(nthread, thread_cores, true, [&](std::size_t t) {
+                for_part_2d(t, nthread, width, height, [&](std::size_t row, std::size_t nrow,
+                                                           std::size_t col, std::size_t ncol) {
+                    set_rows((char*)ptr + row*stride + col, stride, value, ncol, nrow);
+                });
+            });
+            return RBStatus::STATUS_SUCCESS;
+        }
+
+        RBStatus lockMemory(void* ptr, std::size_t size) {
+            RB_ASSERT(ptr || !size, RBStatus::STATUS_INVALID_POINTER);
+#if defined __linux__ && __linux__
+            RB_ASSERT(::mlock(ptr, size) == 0, RBStatus::STATUS_MEM_OP_FAILED);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+#ifdef RINGBUFFER_WITH_NUMA
+        namespace {
+            // Calls mbind for the pages covering [ptr, ptr+size), moving pages already faulted in
+            RBStatus mbind_pages(void* ptr, std::size_t size, int mode, struct bitmask* nodes) {
+                std::uintptr_t page_size = getPageSize();
+                std::uintptr_t beg = reinterpret_cast<std::uintptr_t>(ptr) & ~(page_size-1);
+                std::uintptr_t end = util::round_up(reinterpret_cast<std::uintptr_t>(ptr) + size, page_size);
+                long ret = ::mbind(reinterpret_cast<void*>(beg), end - beg, mode,
+                                   nodes->maskp, nodes->size + 1, MPOL_MF_MOVE);
+                numa_bitmask_free(nodes);
+                RB_ASSERT(ret == 0, RBStatus::STATUS_MEM_OP_FAILED);
+                return RBStatus::STATUS_SUCCESS;
+            }
+
+            // Queries the node of every page covering [ptr, ptr+size), -errno for pages not faulted in
+            RBStatus page_nodes(void* ptr, std::size_t size, std::vector<void*>* pages, std::vector<int>* nodes) {
+                std::uintptr_t page_size = getPageSize();
+                std::uintptr_t beg = reinterpret_cast<std::uintptr_t>(ptr) & ~(page_size-1);
+                std::uintptr_t end = util::round_up(reinterpret_cast<std::uintptr_t>(ptr) + size, page_size);
+                pages->resize((end - beg) / page_size);
+                nodes->resize(pages->size());
+                for( std::size_t i=0; i<pages->size(); ++i ) {
+                    (*pages)[i] = reinterpret_cast<void*>(beg + i*page_size);
+                }
+                RB_ASSERT(::move_pages(0, pages->size(), pages->data(), nullptr, nodes->data(), 0) == 0,
+                          RBStatus::STATUS_MEM_OP_FAILED);
+                return RBStatus::STATUS_SUCCESS;
+            }
+        } // namespace
+#endif
+
+        RBStatus getNumaNodeCount(int* count) {
+            RB_ASSERT(count, RBStatus::STATUS_INVALID_POINTER);
+#ifdef RINGBUFFER_WITH_NUMA
+            RB_ASSERT(numa_available() != -1, RBStatus::STATUS_UNSUPPORTED);
+            *count = numa_max_node() + 1;
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus getNumaNodeOfCore(int core, int* node) {
+            RB_ASSERT(node, RBStatus::STATUS_INVALID_POINTER);
+#ifdef RINGBUFFER_WITH_NUMA
+            RB_ASSERT(numa_available() != -1, RBStatus::STATUS_UNSUPPORTED);
+            *node = numa_node_of_cpu(core);
+            RB_ASSERT(*node != -1, RBStatus::STATUS_INVALID_ARGUMENT);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            (void)core;
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus getNumaNodeOfAddress(const void* ptr, int* node) {
+            RB_ASSERT(ptr, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(node, RBStatus::STATUS_INVALID_POINTER);
+#ifdef RINGBUFFER_WITH_NUMA
+            RB_ASSERT(numa_available() != -1, RBStatus::STATUS_UNSUPPORTED);
+            RB_ASSERT(::get_mempolicy(node, nullptr, 0, const_cast<void*>(ptr), MPOL_F_NODE | MPOL_F_ADDR) == 0,
+                      RBStatus::STATUS_MEM_OP_FAILED);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus bindToNumaNode(void* ptr, std::size_t size, int node) {
+            RB_ASSERT(ptr || !size, RBStatus::STATUS_INVALID_POINTER);
+#ifdef RINGBUFFER_WITH_NUMA
+            RB_ASSERT(numa_available() != -1, RBStatus::STATUS_UNSUPPORTED);
+            RB_ASSERT(node >= 0 && node <= numa_max_node(), RBStatus::STATUS_INVALID_ARGUMENT);
+            if( !size ) {
+                return RBStatus::STATUS_SUCCESS;
+            }
+            struct bitmask* nodes = numa_allocate_nodemask();
+            numa_bitmask_setbit(nodes, node);
+            return mbind_pages(ptr, size, MPOL_BIND, nodes);
+#else
+            (void)node;
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus interleaveNumaNodes(void* ptr, std::size_t size, const int* nodes, std::size_t nnode) {
+            RB_ASSERT(ptr || !size, RBStatus::STATUS_INVALID_POINTER);
+#ifdef RINGBUFFER_WITH_NUMA
+            RB_ASSERT(numa_available() != -1, RBStatus::STATUS_UNSUPPORTED);
+            for( std::size_t i=0; nodes && i<nnode; ++i ) {
+                RB_ASSERT(nodes[i] >= 0 && nodes[i] <= numa_max_node(), RBStatus::STATUS_INVALID_ARGUMENT);
+            }
+            if( !size ) {
+                return RBStatus::STATUS_SUCCESS;
+            }
+            struct bitmask* mask = numa_allocate_nodemask();
+            if( nodes ) {
+                for( std::size_t i=0; i<nnode; ++i ) {
+                    numa_bitmask_setbit(mask, nodes[i]);
+                }
+            } else {
+                copy_bitmask_to_bitmask(numa_all_nodes_ptr, mask);
+            }
+            return mbind_pages(ptr, size, MPOL_INTERLEAVE, mask);
+#else
+            (void)nodes;
+            (void)nnode;
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus migrateToNumaNode(void* ptr, std::size_t size, int node, std::size_t* nmoved) {
+            RB_ASSERT(ptr || !size, RBStatus::STATUS_INVALID_POINTER);
+            if( nmoved ) {
+                *nmoved = 0;
+            }
+#ifdef RINGBUFFER_WITH_NUMA
+            RB_ASSERT(numa_available() != -1, RBStatus::STATUS_UNSUPPORTED);
+            RB_ASSERT(node >= 0 && node <= numa_max_node(), RBStatus::STATUS_INVALID_ARGUMENT);
+            if( !size ) {
+                return RBStatus::STATUS_SUCCESS;
+            }
+            std::vector<void*> pages;
+            std::vector<int>   before, after;
+            if( nmoved ) {
+                RB_ASSERT(page_nodes(ptr, size, &pages, &before) == RBStatus::STATUS_SUCCESS, RBStatus::STATUS_MEM_OP_FAILED);
+            }
+            struct bitmask* nodes = numa_allocate_nodemask();
+            numa_bitmask_setbit(nodes, node);
+            RB_ASSERT(mbind_pages(ptr, size, MPOL_BIND, nodes) == RBStatus::STATUS_SUCCESS, RBStatus::STATUS_MEM_OP_FAILED);
+            if( nmoved ) {
+                // Note: Pages mapped by other processes as well are not moved by MPOL_MF_MOVE,
+                //         so count what actually changed rather than what was requested
+                RB_ASSERT(page_nodes(ptr, size, &pages, &after) == RBStatus::STATUS_SUCCESS, RBStatus::STATUS_MEM_OP_FAILED);
+                for( std::size_t i=0; i<pages.size(); ++i ) {
+                    if( before[i] >= 0 && before[i] != node && after[i] == node ) {
+                        *nmoved += getPageSize();
+                    }
+                }
+            }
+            return RBStatus::STATUS_SUCCESS;
+#else
+            (void)node;
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus unlockMemory(void* ptr, std::size_t size) {
+            RB_ASSERT(ptr || !size, RBStatus::STATUS_INVALID_POINTER);
+#if defined __linux__ && __linux__
+            RB_ASSERT(::munlock(ptr, size) == 0, RBStatus::STATUS_MEM_OP_FAILED);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus discardMemory(void* ptr, std::size_t size, std::size_t page_size, bool shared) {
+            RB_ASSERT(ptr || !size, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(page_size && (page_size & (page_size-1)) == 0, RBStatus::STATUS_INVALID_ARGUMENT);
+#if defined __linux__ && __linux__
+            // Only whole pages can be given back, the partial ones at either end stay
+            std::uintptr_t beg = util::round_up(reinterpret_cast<std::uintptr_t>(ptr), page_size);
+            std::uintptr_t end = (reinterpret_cast<std::uintptr_t>(ptr) + size) & ~(page_size-1);
+            if( end <= beg ) {
+                return RBStatus::STATUS_SUCCESS;
+            }
+            // Note: MADV_DONTNEED only unmaps shared pages, MADV_REMOVE frees their backing as well
+            RB_ASSERT(::madvise(reinterpret_cast<void*>(beg), end - beg, shared ? MADV_REMOVE : MADV_DONTNEED) == 0,
+                      RBStatus::STATUS_MEM_OP_FAILED);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus getResidentSize(const void* ptr, std::size_t size, std::size_t* nresident) {
+            RB_ASSERT(ptr || !size, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(nresident, RBStatus::STATUS_INVALID_POINTER);
+#if defined __linux__ && __linux__
+            std::uintptr_t page_size = getPageSize();
+            std::uintptr_t beg = reinterpret_cast<std::uintptr_t>(ptr) & ~(page_size-1);
+            std::uintptr_t end = util::round_up(reinterpret_cast<std::uintptr_t>(ptr) + size, page_size);
+            // Queried in chunks to bound the size of the page vector
+            const std::size_t max_npage = 1 << 16;
+            std::vector<unsigned char> resident(std::min(std::size_t((end - beg) / page_size), max_npage));
+            std::size_t npage_resident = 0;
+            for( std::uintptr_t addr=beg; addr<end; ) {
+                std::size_t npage = std::min(std::size_t((end - addr) / page_size), max_npage);
+                RB_ASSERT(::mincore(reinterpret_cast<void*>(addr), npage * page_size, resident.data()) == 0,
+                          RBStatus::STATUS_MEM_OP_FAILED);
+                for( std::size_t i=0; i<npage; ++i ) {
+                    npage_resident += (resident[i] & 1);
+                }
+                addr += npage * page_size;
+            }
+            *nresident = npage_resident * page_size;
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
     } // namespace memory
 } // namespace ringbuffer
 
@@ -0,0 +1,252 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#include "ringbuffer/detail/proclog.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <thread>
+
+#if defined __linux__ && __linux__
+#include <pthread.h>       // For pthread_atfork
+#include <signal.h>        // For kill
+#include <unistd.h>        // For getpid
+#endif
+
+namespace ringbuffer {
+    namespace proclog {
+
+        namespace {
+            namespace fs = std::filesystem;
+
+            std::atomic<std::int64_t> g_interval_ms{RINGBUFFER_PROCLOG_INTERVAL_MS};
+
+            bool process_alive(const std::string& pid) {
+#if defined __linux__ && __linux__
+                char* end = nullptr;
+                long value = std::strtol(pid.c_str(), &end, 10);
+                if( pid.empty() || *end != '\0' || value <= 0 ) {
+                    return true; // not a process directory, leave it alone
+                }
+                return ::kill(pid_t(value), 0) == 0 || errno != ESRCH;
+#else
+                return true;
+#endif
+            }
+
+            std::string make_base_directory() {
+                const char* base_env = std::getenv("RINGBUFFER_PROCLOG_DIR");
+                fs::path base = (base_env && *base_env) ? base_env : RINGBUFFER_PROCLOG_DIR;
+                std::error_code ec;
+                // Directories of processes that died without cleaning up are removed
+                for( fs::directory_iterator it(base, ec), end; !ec && it != end; it.increment(ec) ) {
+                    if( !process_alive(it->path().filename().string()) ) {
+                        std::error_code ignored;
+                        fs::remove_all(it->path(), ignored);
+                    }
+                }
+                return base.string();
+            }
+
+            /*
+             * Process-wide thread that periodically rewrites all ProcLog files.
+             * Note: Leaked on purpose, rings may still be destroyed during static destruction.
+             *         The thread is started with the first ProcLog and sleeps while there are none.
+             */
+            class Monitor {
+            public:
+                static Monitor& get() {
+                    static Monitor* monitor = new Monitor();
+                    return *monitor;
+                }
+
+                Monitor() {
+#if defined __linux__ && __linux__
+                    // Note: A forked child has no monitor thread and must not inherit a locked mutex.
+                    //         The condition still counts the parent's waiting thread, so the child
+                    //         gets a fresh one (the copy is leaked, destroying it is undefined).
+                    ::pthread_atfork([]() { Monitor::get().m_mutex.lock(); },
+                                     []() { Monitor::get().m_mutex.unlock(); },
+                                     []() {
+                                         auto& monitor = Monitor::get();
+                                         monitor.m_started = false;
+                                         monitor.m_logs.clear();
+                                         monitor.m_condition.release();
+                                         monitor.m_condition.reset(new std::condition_variable());
+                                         monitor.m_mutex.unlock();
+                                     });
+#endif
+                }
+
+                void add(ProcLog* log) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_logs.insert(log);
+                    if( !m_started ) {
+                        m_started = true;
+                        std::thread(&Monitor::run, this).detach();
+                    }
+                    m_condition->notify_all();
+                }
+
+                // Note: Updates run with m_mutex held, so log is not used anymore once this returns
+                void remove(ProcLog* log) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_logs.erase(log);
+                }
+
+                void interval_changed() {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_condition->notify_all();
+                }
+
+            private:
+                void run() {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    while( true ) {
+                        m_condition->wait(lock, [&]() {
+                            return !m_logs.empty();
+                        });
+                        m_condition->wait_for(lock, getUpdateInterval());
+                        for( auto* log : m_logs ) {
+                            log->update();
+                        }
+                    }
+                }
+
+                std::mutex              m_mutex;
+                std::unique_ptr<std::condition_variable> m_condition{new std::condition_variable()};
+                std::set<ProcLog*>      m_logs;
+                bool                    m_started{false};
+            };
+        }
+
+        std::string directory() {
+            static const std::string base = make_base_directory();
+#if defined __linux__ && __linux__
+            return base + "/" + std::to_string(::getpid());
+#else
+            return base + "/0";
+#endif
+        }
+
+        void setUpdateInterval(std::chrono::milliseconds interval) {
+            g_interval_ms.store(std::max<std::int64_t>(interval.count(), 1));
+            Monitor::get().interval_changed();
+        }
+
+        std::chrono::milliseconds getUpdateInterval() {
+            return std::chrono::milliseconds(g_interval_ms.load());
+        }
+
+        ProcLog::ProcLog(const std::string& block, const std::string& name, source_type source)
+                : m_source(std::move(source)) {
+            std::string filename = name;
+            std::replace(filename.begin(), filename.end(), '/', '_');
+            fs::path dir = fs::path(directory()) / block;
+            std::error_code ec;
+            fs::create_directories(dir, ec);
+            if( ec ) {
+                // Note: Monitoring is best effort, a missing /dev/shm must not break the ring
+                spdlog::warn("ProcLog: cannot create {0}: {1}", dir.string(), ec.message());
+                return;
+            }
+            m_path = (dir / filename).string();
+#if defined __linux__ && __linux__
+            m_pid = long(::getpid());
+#endif
+            this->update();
+            Monitor::get().add(this);
+        }
+
+        ProcLog::~ProcLog() {
+            if( m_path.empty() ) {
+                return;
+            }
+            Monitor::get().remove(this);
+#if defined __linux__ && __linux__
+            if( m_pid != long(::getpid()) ) {
+                return;
+            }
+#endif
+            std::error_code ec;
+            fs::remove(m_path, ec);
+        }
+
+        void ProcLog::set_static(std::string contents) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_static = std::move(contents);
+        }
+
+        void ProcLog::update() {
+            if( m_path.empty() ) {
+                return;
+            }
+            // Note: Also serializes updates from the monitor thread and explicit calls
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::string contents = m_static;
+            if( m_source ) {
+                contents += m_source();
+            }
+            // Note: Written to a temporary file and renamed, so readers always see a complete entry
+            std::string tmp_path = m_path + ".tmp";
+            {
+                std::ofstream file(tmp_path, std::ios::out | std::ios::trunc);
+                if( !file ) {
+                    return;
+                }
+                file << contents;
+            }
+            std::error_code ec;
+            fs::rename(tmp_path, m_path, ec);
+        }
+
+    }
+}
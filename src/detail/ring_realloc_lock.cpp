@@ -63,7 +63,8 @@ namespace ringbuffer {
         RingReallocLock::~RingReallocLock() {
             auto& state = m_ring->get_state();
             --state.nrealloc_pending;
-            state.read_condition.notify_all();
+            ++state.wait_events;
+            state.read_waiters.notify_all();
             state.write_condition.notify_all();
         }
 
@@ -0,0 +1,282 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#include "ringbuffer/detail/shm.h"
+#include "ringbuffer/detail/memory.h"
+#include "ringbuffer/detail/util.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if defined __linux__ && __linux__
+#include <fcntl.h>         // For O_* constants
+#include <linux/futex.h>   // For FUTEX_WAIT, FUTEX_WAKE
+#include <signal.h>        // For kill
+#include <sys/mman.h>      // For shm_open, mmap
+#include <sys/stat.h>      // For fstat
+#include <sys/syscall.h>   // For SYS_futex
+#include <unistd.h>        // For ftruncate, syscall
+#endif
+
+namespace ringbuffer {
+    namespace shm {
+
+        namespace {
+            const std::uint64_t SHM_MAGIC   = 0x5242534852494e47ull; // "RBSHRING"
+            const std::uint32_t SHM_VERSION = 2;
+
+            std::string segment_name(const std::string& name) {
+                std::string result = "/ringbuffer." + name;
+                std::replace(result.begin()+1, result.end(), '/', '_');
+                return result;
+            }
+
+            std::size_t header_bytes() {
+                return util::round_up(sizeof(RingHeader), memory::getPageSize());
+            }
+
+#if defined __linux__ && __linux__
+            // True only if the segment is complete and the process that created it no longer
+            //   exists. Segments still being created, or of another version, are kept.
+            bool segment_stale(const std::string& shm_name) {
+                int fd = ::shm_open(shm_name.c_str(), O_RDONLY, 0600);
+                if( fd == -1 ) {
+                    // Removed meanwhile, nothing left to take over
+                    return errno == ENOENT;
+                }
+                std::size_t data_offset = header_bytes();
+                struct stat st;
+                bool stale = false;
+                if( ::fstat(fd, &st) == 0 && std::size_t(st.st_size) >= data_offset ) {
+                    void* header = ::mmap(nullptr, data_offset, PROT_READ, MAP_SHARED, fd, 0);
+                    if( header != MAP_FAILED ) {
+                        const auto* ring_header = reinterpret_cast<const RingHeader*>(header);
+                        bool valid = (ring_header->magic == SHM_MAGIC);
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        pid_t pid = pid_t(ring_header->creator_pid);
+                        // Note: EPERM means the process exists but belongs to another user
+                        stale = (valid && ring_header->version == SHM_VERSION && pid > 0 &&
+                                 ::kill(pid, 0) == -1 && errno == ESRCH);
+                        ::munmap(header, data_offset);
+                    }
+                }
+                ::close(fd);
+                return stale;
+            }
+#endif
+
+            void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected, std::chrono::nanoseconds timeout) {
+#if defined __linux__ && __linux__
+                struct timespec ts{};
+                struct timespec* pts = nullptr;
+                if( timeout.count() > 0 ) {
+                    ts.tv_sec  = time_t(timeout.count() / 1000000000);
+                    ts.tv_nsec = long(timeout.count() % 1000000000);
+                    pts = &ts;
+                }
+                // Note: Not FUTEX_PRIVATE_FLAG, the word is shared between processes
+                ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, pts, nullptr, 0);
+#else
+                if( word.load() == expected ) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+#endif
+            }
+
+            void futex_wake(std::atomic<std::uint32_t>& word, int count) {
+#if defined __linux__ && __linux__
+                ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+#endif
+            }
+        }
+
+        RBStatus create(const std::string& name, std::size_t span, std::size_t ghost_span,
+                        std::size_t nringlet, Segment* segment) {
+            RB_ASSERT(segment, RBStatus::STATUS_INVALID_POINTER);
+            RB_ASSERT(span && nringlet, RBStatus::STATUS_INVALID_ARGUMENT);
+#if defined __linux__ && __linux__
+            std::string shm_name = segment_name(name);
+            int fd = ::shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if( fd == -1 && errno == EEXIST ) {
+                // Only a segment left behind by a crashed writer is replaced, a live writer keeps its name
+                RB_ASSERT(segment_stale(shm_name), RBStatus::STATUS_RING_NOT_AVAILABLE);
+                ::shm_unlink(shm_name.c_str());
+                fd = ::shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+                RB_ASSERT(fd != -1 || errno != EEXIST, RBStatus::STATUS_RING_NOT_AVAILABLE);
+            }
+            RB_ASSERT(fd != -1, RBStatus::STATUS_MEM_ALLOC_FAILED);
+            std::size_t data_offset = header_bytes();
+            if( ::ftruncate(fd, off_t(data_offset + span*nringlet)) != 0 ) {
+                ::close(fd);
+                ::shm_unlink(shm_name.c_str());
+                RB_FAIL("ftruncate shared memory", RBStatus::STATUS_MEM_ALLOC_FAILED);
+            }
+            void* header = ::mmap(nullptr, data_offset, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            void* data = nullptr;
+            if( header == MAP_FAILED ||
+                memory::mapMirrored(&data, fd, data_offset, span, nringlet) != RBStatus::STATUS_SUCCESS ) {
+                if( header != MAP_FAILED ) {
+                    ::munmap(header, data_offset);
+                }
+                ::close(fd);
+                ::shm_unlink(shm_name.c_str());
+                RB_FAIL("map shared memory", RBStatus::STATUS_MEM_ALLOC_FAILED);
+            }
+            ::close(fd);
+
+            auto* ring_header = new (header) RingHeader();
+            ring_header->version     = SHM_VERSION;
+            ring_header->data_offset = data_offset;
+            ring_header->ghost_span  = ghost_span;
+            ring_header->span        = span;
+            ring_header->stride      = 2*span;
+            ring_header->nringlet    = nringlet;
+            ring_header->creator_pid = std::int64_t(::getpid());
+            // Note: The magic is published last, attaching processes check it
+            std::atomic_thread_fence(std::memory_order_release);
+            ring_header->magic = SHM_MAGIC;
+
+            segment->header   = ring_header;
+            segment->data     = (pointer)data;
+            segment->span     = span;
+            segment->nringlet = nringlet;
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus attach(const std::string& name, Segment* segment) {
+            RB_ASSERT(segment, RBStatus::STATUS_INVALID_POINTER);
+#if defined __linux__ && __linux__
+            std::string shm_name = segment_name(name);
+            int fd = ::shm_open(shm_name.c_str(), O_RDWR, 0600);
+            RB_ASSERT(fd != -1, RBStatus::STATUS_RING_NOT_AVAILABLE);
+            std::size_t data_offset = header_bytes();
+            void* header = ::mmap(nullptr, data_offset, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if( header == MAP_FAILED ) {
+                ::close(fd);
+                RB_FAIL("map shared memory", RBStatus::STATUS_RING_NOT_AVAILABLE);
+            }
+            auto* ring_header = reinterpret_cast<RingHeader*>(header);
+            bool valid = (ring_header->magic == SHM_MAGIC);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            valid = valid && ring_header->version == SHM_VERSION && ring_header->data_offset == data_offset;
+            void* data = nullptr;
+            if( !valid ||
+                memory::mapMirrored(&data, fd, data_offset, ring_header->span, ring_header->nringlet) != RBStatus::STATUS_SUCCESS ) {
+                ::munmap(header, data_offset);
+                ::close(fd);
+                RB_FAIL("valid shared memory segment", RBStatus::STATUS_RING_NOT_AVAILABLE);
+            }
+            ::close(fd);
+
+            segment->header   = ring_header;
+            segment->data     = (pointer)data;
+            segment->span     = ring_header->span;
+            segment->nringlet = ring_header->nringlet;
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus detach(Segment* segment) {
+            RB_ASSERT(segment && segment->header, RBStatus::STATUS_INVALID_POINTER);
+#if defined __linux__ && __linux__
+            memory::freeMirrored(segment->data, segment->span, segment->nringlet);
+            ::munmap(segment->header, header_bytes());
+            *segment = Segment();
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        RBStatus unlink(const std::string& name) {
+#if defined __linux__ && __linux__
+            RB_ASSERT(::shm_unlink(segment_name(name).c_str()) == 0, RBStatus::STATUS_INVALID_ARGUMENT);
+            return RBStatus::STATUS_SUCCESS;
+#else
+            return RBStatus::STATUS_UNSUPPORTED;
+#endif
+        }
+
+        void lock(std::atomic<std::uint32_t>& word) {
+            // 0: unlocked, 1: locked, 2: locked with waiters
+            std::uint32_t c = 0;
+            if( word.compare_exchange_strong(c, 1) ) {
+                return;
+            }
+            if( c != 2 ) {
+                c = word.exchange(2);
+            }
+            while( c != 0 ) {
+                futex_wait(word, 2, std::chrono::nanoseconds(0));
+                c = word.exchange(2);
+            }
+        }
+
+        void unlock(std::atomic<std::uint32_t>& word) {
+            if( word.exchange(0) == 2 ) {
+                futex_wake(word, 1);
+            }
+        }
+
+        void wait(std::atomic<std::uint32_t>& event, std::uint32_t expected, std::chrono::nanoseconds timeout) {
+            futex_wait(event, expected, timeout);
+        }
+
+        void notify(std::atomic<std::uint32_t>& event, const std::atomic<std::uint32_t>& nwaiting) {
+            ++event;
+            if( nwaiting.load() != 0 ) {
+                futex_wake(event, INT_MAX);
+            }
+        }
+
+    }
+}
@@ -0,0 +1,141 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#include "ringbuffer/detail/thread_pool.h"
+#include "ringbuffer/detail/affinity.h"
+
+#if defined __linux__ && __linux__
+#include <unistd.h> // For getpid
+#endif
+
+namespace ringbuffer {
+    namespace util {
+
+        namespace {
+            int current_pid() {
+#if defined __linux__ && __linux__
+                return int(::getpid());
+#else
+                return 0;
+#endif
+            }
+        }
+
+        ThreadPool::ThreadPool(std::size_t nthread, const std::vector<int>& thread_cores)
+            : m_pid(current_pid()) {
+            m_threads.reserve(nthread);
+            for( std::size_t t=0; t<nthread; ++t ) {
+                int core = t < thread_cores.size() ? thread_cores[t] : -1;
+                m_threads.emplace_back(&ThreadPool::worker, this, t, core);
+            }
+        }
+
+        ThreadPool::~ThreadPool() {
+            if( m_pid != current_pid() ) {
+                // The workers only exist in the parent, waking or joining them would hang
+                for( auto& thread : m_threads ) {
+                    thread.detach();
+                }
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_start.notify_all();
+            for( auto& thread : m_threads ) {
+                if( thread.joinable() ) {
+                    thread.join();
+                }
+            }
+        }
+
+        bool ThreadPool::try_run(const std::function<void(std::size_t)>& fn, bool caller_runs) {
+            // Threads do not survive fork, a child process must not wait for them
+            if( m_threads.empty() || m_pid != current_pid() ) {
+                return false;
+            }
+            std::unique_lock<std::mutex> run_lock(m_run_mutex, std::try_to_lock);
+            if( !run_lock.owns_lock() ) {
+                return false;
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job     = &fn;
+            m_pending = m_threads.size();
+            ++m_generation;
+            m_start.notify_all();
+            if( caller_runs ) {
+                // The calling thread takes a share instead of only waiting for the workers
+                lock.unlock();
+                fn(m_threads.size());
+                lock.lock();
+            }
+            m_done.wait(lock, [this]() { return m_pending == 0; });
+            m_job = nullptr;
+            return true;
+        }
+
+        void ThreadPool::worker(std::size_t t, int core) {
+            if( core != -1 ) {
+                affinity::affinitySetCore(core);
+            }
+            std::size_t generation = 0;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while( true ) {
+                m_start.wait(lock, [&]() { return m_stop || m_generation != generation; });
+                if( m_stop ) {
+                    return;
+                }
+                generation = m_generation;
+                const auto* job = m_job;
+                lock.unlock();
+                (*job)(t);
+                lock.lock();
+                if( --m_pending == 0 ) {
+                    m_done.notify_one();
+                }
+            }
+        }
+
+    }
+}
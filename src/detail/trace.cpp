@@ -43,6 +43,19 @@
 
 #include "ringbuffer/detail/trace.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#if defined __linux__ && __linux__
+#include <unistd.h>        // For getpid
+#endif
+
 namespace ringbuffer {
     namespace trace {
         namespace profile_detail {
@@ -68,6 +81,167 @@ namespace ringbuffer {
 
         } // namespace profile_detail
 
+        namespace cpu {
+
+            namespace {
+                struct Event {
+                    const char*   name;
+                    std::uint64_t begin;
+                    std::uint64_t end;
+                };
+
+                // Events of one thread: only the owning thread appends, count is published
+                //   with release so that dump sees complete events.
+                struct ThreadBuffer {
+                    explicit ThreadBuffer(std::size_t tid_) : tid(tid_), events(RINGBUFFER_TRACE_EVENTS) {}
+                    std::size_t                tid;
+                    std::vector<Event>         events;
+                    std::atomic<std::size_t>   count{0};
+                    std::atomic<std::uint64_t> dropped{0};
+                };
+
+                // Note: Buffers outlive their threads, so events of finished threads are still dumped.
+                //         Leaked on purpose, traced scopes may still end during static destruction.
+                struct Registry {
+                    std::mutex                                 mutex;
+                    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+                    std::set<std::string>                      names;
+                    std::chrono::steady_clock::time_point      epoch{std::chrono::steady_clock::now()};
+                };
+
+                void dump_at_exit() {
+                    const char* filename = std::getenv("RINGBUFFER_TRACE_FILE");
+                    if( filename && *filename ) {
+                        trace::dump(std::string(filename));
+                    }
+                }
+
+                Registry& registry() {
+                    static Registry* instance = []() {
+                        auto* r = new Registry();
+                        std::atexit(dump_at_exit);
+                        return r;
+                    }();
+                    return *instance;
+                }
+
+                ThreadBuffer& thread_buffer() {
+                    thread_local ThreadBuffer* buffer = nullptr;
+                    if( !buffer ) {
+                        auto& r = registry();
+                        std::lock_guard<std::mutex> lock(r.mutex);
+                        r.buffers.emplace_back(new ThreadBuffer(r.buffers.size()));
+                        buffer = r.buffers.back().get();
+                    }
+                    return *buffer;
+                }
+            }
+
+            std::uint64_t now() {
+                return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - registry().epoch).count());
+            }
+
+            void record(const char* name, std::uint64_t begin, std::uint64_t end) {
+                auto& buffer = thread_buffer();
+                std::size_t index = buffer.count.load(std::memory_order_relaxed);
+                if( index >= buffer.events.size() ) {
+                    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                buffer.events[index] = Event{name, begin, end};
+                buffer.count.store(index + 1, std::memory_order_release);
+            }
+
+            const char* intern(const std::string& name) {
+                auto& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                return r.names.insert(name).first->c_str();
+            }
+
+        } // namespace cpu
+
+        namespace {
+            void write_json_string(std::ostream& out, const char* str) {
+                out << '"';
+                for( const char* c = str; *c; ++c ) {
+                    switch( *c ) {
+                        case '"':  out << "\\\""; break;
+                        case '\\': out << "\\\\"; break;
+                        case '\n': out << "\\n"; break;
+                        default:
+                            if( static_cast<unsigned char>(*c) >= 0x20 ) {
+                                out << *c;
+                            }
+                    }
+                }
+                out << '"';
+            }
+        }
+
+        void dump(std::ostream& out) {
+            auto& r = cpu::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+#if defined __linux__ && __linux__
+            long pid = long(::getpid());
+#else
+            long pid = 0;
+#endif
+            std::uint64_t dropped = 0;
+            bool first = true;
+            auto separator = [&]() {
+                out << (first ? "\n" : ",\n");
+                first = false;
+            };
+            out << "{\"traceEvents\":[";
+            for( const auto& buffer : r.buffers ) {
+                separator();
+                out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+                    << ",\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+                std::size_t count = buffer->count.load(std::memory_order_acquire);
+                for( std::size_t i = 0; i < count; ++i ) {
+                    const auto& event = buffer->events[i];
+                    separator();
+                    // Note: Timestamps are in microseconds, fractions keep the nanoseconds
+                    out << "{\"name\":";
+                    write_json_string(out, event.name);
+                    out << ",\"cat\":\"ringbuffer\",\"ph\":\"X\",\"ts\":" << (event.begin / 1000) << "."
+                        << std::to_string(1000 + event.begin % 1000).substr(1)
+                        << ",\"dur\":" << ((event.end - event.begin) / 1000) << "."
+                        << std::to_string(1000 + (event.end - event.begin) % 1000).substr(1)
+                        << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid << "}";
+                }
+                dropped += buffer->dropped.load(std::memory_order_relaxed);
+            }
+            out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+        }
+
+        RBStatus dump(const std::string& filename) {
+            std::ofstream out(filename, std::ios::out | std::ios::trunc);
+            RB_ASSERT(out.good(), RBStatus::STATUS_INVALID_ARGUMENT);
+            dump(out);
+            return (out.good() ? RBStatus::STATUS_SUCCESS : RBStatus::STATUS_INTERNAL_ERROR);
+        }
+
+        void clear() {
+            auto& r = cpu::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for( auto& buffer : r.buffers ) {
+                buffer->count.store(0);
+                buffer->dropped.store(0);
+            }
+        }
+
+        std::size_t getDroppedEvents() {
+            auto& r = cpu::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            std::size_t dropped = 0;
+            for( const auto& buffer : r.buffers ) {
+                dropped += buffer->dropped.load(std::memory_order_relaxed);
+            }
+            return dropped;
+        }
+
 #ifdef RINGBUFFER_WITH_CUDA
 
         namespace nvtx {
@@ -132,14 +306,30 @@ namespace ringbuffer {
         }
 #endif
 
+        ScopedTracer::ScopedTracer(const char* name, cudaStream_t stream)
+                : _cpu_name(name),
+                  _cpu_begin(cpu::now()),
+                  _name(name),
+                  _color(profile_detail::get_color(profile_detail::simple_hash(name))),
+                  _category(123),
+                  _stream(stream) {
+            this->start();
+        }
+
         ScopedTracer::ScopedTracer(const std::string& name, cudaStream_t stream)
-                : _name(name),
+                : _cpu_name(cpu::intern(name)),
+                  _cpu_begin(cpu::now()),
+                  _name(name),
                   _color(profile_detail::get_color(profile_detail::simple_hash(name.c_str()))),
                   _category(123),
                   _stream(stream) {
+            this->start();
+        }
+
+        void ScopedTracer::start() {
 #ifdef RINGBUFFER_WITH_NVTOOLSEXT
             if( _stream ) {
-                nvtx::g_nvtx_streams[_stream].push(new nvtx::AsyncTracer(stream));
+                nvtx::g_nvtx_streams[_stream].push(new nvtx::AsyncTracer(_stream));
                 nvtx::g_nvtx_streams[_stream].back()->start(("[G]"+_name).c_str(),
                                                             _color, _category);
             } else {
@@ -153,6 +343,7 @@ namespace ringbuffer {
         }
 
         ScopedTracer::~ScopedTracer() {
+            cpu::record(_cpu_name, _cpu_begin, cpu::now());
 #ifdef RINGBUFFER_WITH_NVTOOLSEXT
             if( _stream ) {
                 nvtx::g_nvtx_streams[_stream].front()->end();
@@ -45,11 +45,20 @@
 #include "ringbuffer/ring.h"
 #include "ringbuffer/sequence.h"
 #include "ringbuffer/detail/memory.h"
+#include "ringbuffer/detail/affinity.h"
 #include "ringbuffer/detail/ring_realloc_lock.h"
 #include "ringbuffer/detail/guarantee.h"
 #include "ringbuffer/detail/cuda.h"
 #include "ringbuffer/detail/util.h"
+#include "ringbuffer/detail/shm.h"
+#include "ringbuffer/detail/trace.h"
+#include "ringbuffer/detail/probes.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <mutex>
+#include <sstream>
+#include <thread>
 
 #ifdef RINGBUFFER_WITH_NUMA
 #include <numa.h>
@@ -62,34 +71,136 @@ namespace ringbuffer {
         spdlog::set_default_logger(logger);
     }
 
-    void Ring::_add_guarantee(std::size_t offset) {
+    namespace {
+        // Registers the calling thread as waiting on a condition for the duration of the wait,
+        //   so that the spsc fast path knows when it has to take the mutex to notify.
+        class ScopedWaiter {
+            std::atomic<std::size_t>* m_nwaiting;
+        public:
+            explicit ScopedWaiter(std::atomic<std::size_t>* nwaiting) : m_nwaiting(nwaiting) { if( m_nwaiting ) ++*m_nwaiting; }
+            ~ScopedWaiter() { if( m_nwaiting ) --*m_nwaiting; }
+        };
+
+        // Registers a reader blocked in acquire_span, must be used with the ring mutex held
+        class ScopedReadWaiter {
+            state::ReadWaiters&         m_waiters;
+            state::ReadWaiters::Waiter  m_waiter;
+        public:
+            ScopedReadWaiter(state::ReadWaiters& waiters, std::size_t end) : m_waiters(waiters), m_waiter(end) {
+                m_waiters.add(&m_waiter);
+            }
+            ~ScopedReadWaiter() { m_waiters.remove(&m_waiter); }
+            state::condition_type& condition() { return m_waiter.condition; }
+        };
+
+        // Serializes changes to the guarantee table, across processes for shared memory rings
+        class GuaranteeLock {
+            state::RingState& m_state;
+        public:
+            explicit GuaranteeLock(state::RingState& state) : m_state(state) {
+                if( m_state.shm ) {
+                    shm::lock(m_state.shm->guarantees_lock);
+                } else {
+                    m_state.guarantees_mutex.lock();
+                }
+            }
+            ~GuaranteeLock() {
+                if( m_state.shm ) {
+                    shm::unlock(m_state.shm->guarantees_lock);
+                } else {
+                    m_state.guarantees_mutex.unlock();
+                }
+            }
+        };
+    }
+
+    std::size_t Ring::_add_guarantee(std::size_t offset, int* slot) {
         auto& state = get_state();
-        std::scoped_lock<state::mutex_type> lk(state.guarantees_mutex);
-        auto iter = state.guarantees.find(offset);
-        if( iter == state.guarantees.end() ) {
-            state.guarantees.insert(std::make_pair(offset, 1));
+        auto& guarantees = this->_guarantee_table();
+        GuaranteeLock lk(state);
+        offset = this->_clamp_guarantee(offset);
+        int new_slot = guarantees.add(offset);
+        RB_ASSERT_EXCEPTION(new_slot != -1, RBStatus::STATUS_INSUFFICIENT_STORAGE);
+        // Note: The spsc writer may have reserved past the offset before it could see
+        //         the new guarantee, so check again now that it is published.
+        std::size_t clamped = this->_clamp_guarantee(offset);
+        if( clamped != offset ) {
+            guarantees.move_forward(new_slot, clamped);
+        }
+        *slot = new_slot;
+        return clamped;
+    }
+
+    std::size_t Ring::_move_guarantee(int slot, std::size_t offset) {
+        auto& state = get_state();
+        auto& guarantees = this->_guarantee_table();
+        if( delta_type(offset - guarantees.offset(slot)) >= 0 ) {
+            guarantees.move_forward(slot, offset);
         }
         else {
-            ++iter->second;
+            GuaranteeLock lk(state);
+            offset = this->_clamp_guarantee(offset);
+            guarantees.move_back(slot, offset);
+            std::size_t clamped = this->_clamp_guarantee(offset);
+            if( clamped != offset ) {
+                guarantees.move_forward(slot, clamped);
+                offset = clamped;
+            }
+        }
+        ++state.wait_events;
+        state.write_condition.notify_all();
+        if( state.shm ) {
+            shm::notify(state.shm->write_event, state.shm->nwrite_waiting);
         }
+        return offset;
     }
 
-    void Ring::_remove_guarantee(std::size_t offset) {
+    void Ring::_remove_guarantee(int slot) {
         auto& state = get_state();
-        std::scoped_lock<state::mutex_type> lk(state.guarantees_mutex);
-        auto iter = state.guarantees.find(offset);
-        if( iter == state.guarantees.end() ) {
-            throw RBException(RBStatus::STATUS_INTERNAL_ERROR);
+        {
+            GuaranteeLock lk(state);
+            this->_guarantee_table().remove(slot);
         }
-        if( !--iter->second ) {
-            state.guarantees.erase(iter);
-            state.write_condition.notify_all();
+        ++state.wait_events;
+        state.write_condition.notify_all();
+        if( state.shm ) {
+            shm::notify(state.shm->write_event, state.shm->nwrite_waiting);
+        }
+    }
+
+    std::size_t Ring::_clamp_guarantee(std::size_t offset) const {
+        const auto& state = get_state();
+        // A guarantee behind the tail would not protect anything
+        // Note: The writer of a shared memory ring may live in another process
+        std::size_t earliest = state.shm ? state.shm->tail.load() : state.tail.load();
+        if( state.spsc || state.shm ) {
+            // The spsc (or shared memory) writer publishes reserve_head before it pulls the tail
+            std::size_t reserve_head = state.shm ? state.shm->reserve_head.load() : state.reserve_head.load();
+            std::size_t reserve_tail = reserve_head - state.span;
+            if( delta_type(reserve_tail - earliest) > 0 ) {
+                earliest = reserve_tail;
+            }
+        }
+        return delta_type(offset - earliest) < 0 ? earliest : offset;
+    }
+
+    bool Ring::_guarantees_allow(std::size_t reserve_head) {
+        auto& state = get_state();
+        auto& guarantees = this->_guarantee_table();
+        // The cached earliest offset is a lower bound, so it is only recomputed
+        //   when it would hold the writer back.
+        if( guarantees.empty() ||
+            std::size_t(reserve_head - guarantees.earliest_bound()) <= state.span ) {
+            return true;
         }
+        GuaranteeLock lk(state);
+        return (guarantees.empty() ||
+                std::size_t(reserve_head - guarantees.recompute_earliest(reserve_head)) <= state.span);
     }
 
-    std::size_t Ring::_get_earliest_guarantee() {
+    state::GuaranteeTable& Ring::_guarantee_table() {
         auto& state = get_state();
-        return state.guarantees.begin()->first;
+        return state.shm ? state.shm->guarantees : state.guarantees;
     }
 
     state::RingState& Ring::get_state() {
@@ -131,21 +242,50 @@ namespace ringbuffer {
         RB_ASSERT_EXCEPTION(space==RBSpace::SPACE_SYSTEM       ||
                                   space==RBSpace::SPACE_CUDA         ||
                                   space==RBSpace::SPACE_CUDA_HOST    ||
-                                  space==RBSpace::SPACE_CUDA_MANAGED,
+                                  space==RBSpace::SPACE_CUDA_MANAGED ||
+                                  (space==RBSpace::SPACE_SHM && getShmEnabled()),
                             RBStatus::STATUS_INVALID_ARGUMENT);
 #else
-        RB_ASSERT_EXCEPTION(space==RBSpace::SPACE_SYSTEM,
+        RB_ASSERT_EXCEPTION(space==RBSpace::SPACE_SYSTEM ||
+                            (space==RBSpace::SPACE_SHM && getShmEnabled()),
 	                    RBStatus::STATUS_INVALID_ARGUMENT);
 #endif
+        // Note: Shared memory rings are always mirrored, so that processes never have
+        //         to coordinate ghost-region copies.
+        state.mirrored = (space == RBSpace::SPACE_SHM);
+        if( space == RBSpace::SPACE_SYSTEM ) {
+            state.hugepages = memory::getDefaultHugePages();
+        }
 
-        // @todo: add proclog entry here
+        if( getProcLogEnabled() ) {
+            this->_open_proclog(state.name);
+        }
     }
 
     Ring::~Ring() {
         auto& state = get_state();
+        // Note: First, so that the monitor thread does not look at the ring while it is torn down
+        state.proclog.reset();
+        {
+            state::unique_lock_type lock(state.mutex);
+            this->_stop_idle_reclaim(lock);
+        }
+        if( state.migrate_thread.joinable() ) {
+            state.migrate_thread.join();
+        }
         // @todo: Should check if anything is still open here?
-        if( state.buf ) {
-            memory::free_(state.buf, state.space);
+        if( state.shm ) {
+            if( !state.shm_attached ) {
+                shm::unlink(state.name);
+            }
+            shm::detach(&state.shm_segment);
+        }
+        else if( state.buf ) {
+            _free_buffer(state.buf, state.span, state.stride, state.nringlet, state.buf_hugepages, state.buf_memlocked);
+        }
+        if( state.old_buffer.buf ) {
+            const auto& old = state.old_buffer;
+            _free_buffer(old.buf, old.span, old.stride, old.nringlet, old.hugepages, old.memlocked);
         }
         m_sequence_event.disconnect_all();
     }
@@ -153,6 +293,7 @@ namespace ringbuffer {
     void Ring::resize(std::size_t contiguous_span,
                       std::size_t total_span,
                       std::size_t nringlet) {
+        RB_TRACE();
 
         auto& state = get_state();
         state::unique_lock_type lock(state.mutex);
@@ -164,6 +305,24 @@ namespace ringbuffer {
             return;
         }
 
+        // The geometry of a shared memory ring is fixed by the process that created it
+        RB_ASSERT_EXCEPTION(!state.shm_attached, RBStatus::STATUS_INVALID_STATE);
+
+        if( this->_incremental_resize_possible(nringlet) ) {
+            // The pages of the current buffer may still be moving, or a previous resize
+            //   may still be migrating
+            state.realloc_condition.wait(lock, [&state]() {
+                return !state.migrating;
+            });
+            if( contiguous_span <= state.ghost_span &&
+                total_span      <= state.span &&
+                nringlet        <= state.nringlet) {
+                return;
+            }
+            this->_resize_incremental(lock, this->_resize_geometry(contiguous_span, total_span, nringlet));
+            return;
+        }
+
         state::realloc_lock_type realloc_lock(lock, this);
 
         // Check if reallocation is still actually necessary
@@ -172,11 +331,95 @@ namespace ringbuffer {
             nringlet        <= state.nringlet) {
             return;
         }
+        // Other processes may have the segment mapped, so it cannot be reallocated
+        RB_ASSERT_EXCEPTION(!state.shm, RBStatus::STATUS_UNSUPPORTED);
+        // The pages of the old buffer may still be moving to another node
+        state.realloc_condition.wait(lock, [&state]() {
+            return !state.migrating;
+        });
 
         // Perform the reallocation
-        std::size_t  new_ghost_span = std::max(contiguous_span, state.ghost_span);
-        std::size_t  new_span       = std::max(total_span,      state.span);
-        std::size_t  new_nringlet   = std::max(nringlet,        state.nringlet);
+        state::BufferInfo info = this->_resize_geometry(contiguous_span, total_span, nringlet);
+        std::size_t  new_ghost_span = info.ghost_span;
+        std::size_t  new_span       = info.span;
+        std::size_t  new_stride     = info.stride;
+        std::size_t  new_nringlet   = info.nringlet;
+
+        std::vector<int> thread_cores;
+        this->_prepare_buffer(&info, &thread_cores);
+        pointer new_buf = info.buf;
+        bool host     = (state.space != RBSpace::SPACE_CUDA &&
+                         state.space != RBSpace::SPACE_CUDA_MANAGED);
+        bool parallel = !thread_cores.empty();
+        if( state.buf ) {
+            // Note: Host copies bypass the caches, the old data is not read again soon
+            auto migrate = [&](pointer dst, const_pointer src, std::size_t width) {
+                if( parallel ) {
+                    memory::memcpy2DParallel(dst, new_stride, src, state.stride, width, state.nringlet,
+                                             thread_cores.size(), thread_cores.data(), true);
+                } else if( host ) {
+                    memory::memcpy2DNonTemporal(dst, new_stride, src, state.stride, width, state.nringlet);
+                } else {
+                    memory::memcpy2D(dst, new_stride, state.space, src, state.stride, state.space,
+                                     width, state.nringlet);
+                }
+            };
+            // Must move existing data and delete old buf
+            if( _buf_offset(state.tail) < _buf_offset(state.head) ) {
+                // Copy middle to beginning
+                migrate(new_buf, state.buf + _buf_offset(state.tail), std::size_t(state.head - state.tail));
+                state.offset0 = state.tail;
+            }
+            else {
+                // Copy beg to beg and end to end, with larger gap between
+                migrate(new_buf, state.buf, _buf_offset(state.head));
+
+                migrate(new_buf + (_buf_offset(state.tail)+(new_span-state.span)),
+                        state.buf + _buf_offset(state.tail), state.span - _buf_offset(state.tail));
+                state.offset0 = state.head - _buf_offset(state.head); // @todo: Check this for sign/overflow issues
+            }
+
+            if( !state.mirrored ) {
+                // Copy old ghost region to new buffer
+                migrate(new_buf + new_span, state.buf + state.span, state.ghost_span);
+
+                // Copy the part of the beg corresponding to the extra ghost space
+                migrate(new_buf + new_span + state.ghost_span, state.buf + state.ghost_span,
+                        std::min(new_ghost_span, state.span) - state.ghost_span);
+            }
+
+            //_ghost_dirty = true; // @todo: Is this the right thing to do?
+            //_ghost_dirty_beg = new_ghost_span; // @todo: Is this the right thing to do?
+            state.ghost_dirty_beg = 0; // @todo: Is this the right thing to do?
+            _free_buffer(state.buf, state.span, state.stride, state.nringlet, state.buf_hugepages, state.buf_memlocked);
+            cuda::streamSynchronize();
+        }
+        state.buf        = new_buf;
+        state.buf_hugepages = info.hugepages;
+        state.buf_memlocked = info.memlocked;
+        state.buf_numa_nodes = info.numa_nodes;
+        state.ghost_span = new_ghost_span;
+        state.span       = new_span;
+        state.stats_span = new_span;
+        state.stride     = new_stride;
+        state.nringlet   = new_nringlet;
+        RB_PROBE4(resize, state.name.c_str(), state.ghost_span, state.span, state.nringlet);
+
+        this->_update_proclog_static();
+    }
+
+    state::BufferInfo Ring::_resize_geometry(std::size_t contiguous_span, std::size_t total_span, std::size_t nringlet) const {
+        const auto& state = get_state();
+        return this->_buffer_geometry(std::max(contiguous_span, state.ghost_span),
+                                      std::max(total_span,      state.span),
+                                      std::max(nringlet,        state.nringlet));
+    }
+
+    state::BufferInfo Ring::_buffer_geometry(std::size_t contiguous_span, std::size_t total_span, std::size_t nringlet) const {
+        const auto& state = get_state();
+        std::size_t  new_ghost_span = contiguous_span;
+        std::size_t  new_span       = total_span;
+        std::size_t  new_nringlet   = nringlet;
 
         //new_ghost_span = round_up(new_ghost_span, memory::getAlignment());
         //new_span       = round_up(new_span,       memory::getAlignment());
@@ -195,10 +438,34 @@ namespace ringbuffer {
         //new_ghost_span = round_up_pow2(new_ghost_span);
         new_ghost_span = util::round_up(new_ghost_span, memory::getAlignment());
         std::size_t  new_stride = new_span + new_ghost_span;
-        std::size_t  new_nbyte  = new_stride*new_nringlet;
+        if( state.mirrored ) {
+            // The mirror of the whole span acts as ghost region, so the span must cover
+            //   the contiguous span and consist of whole pages
+            new_span   = std::max(new_span, util::round_up_pow2(std::max(new_ghost_span, memory::getPageSize())));
+            new_stride = 2*new_span;
+        }
+        else if( state.hugepages != RBHugePages::HUGEPAGES_NONE ) {
+            // Every ringlet starts on a huge page, the rounding is unused padding after the ghost
+            //   region (the ghost region must not exceed the span)
+            new_stride     = util::round_up(new_stride, memory::getHugePageSize(state.hugepages));
+        }
+        else if( state.numa_policy == RBNumaPolicy::NUMA_RINGLETS ) {
+            // Ringlets are bound to different nodes, so they must not share pages, the rounding
+            //   is unused padding as for huge pages
+            new_stride     = util::round_up(new_stride, memory::getPageSize());
+        }
+        state::BufferInfo info;
+        info.ghost_span = new_ghost_span;
+        info.span       = new_span;
+        info.stride     = new_stride;
+        info.nringlet   = new_nringlet;
+        info.offset0    = state.offset0;
+        return info;
+    }
 
-        //pointer new_buf    = (pointer)rfMalloc(new_nbyte, _space);
-        //std::cout << "new_buf = " << (void*)new_buf << std::endl; // HACK TESTING
+    void Ring::_prepare_buffer(state::BufferInfo* info, std::vector<int>* thread_cores) {
+        auto& state = get_state();
+        std::size_t new_nbyte = info->stride*info->nringlet;
 
 #ifdef RINGBUFFER_WITH_CUDA
         if (state.device != -1) {
@@ -206,68 +473,794 @@ namespace ringbuffer {
         }
 #endif // RINGBUFFER_WITH_CUDA
 
-        pointer new_buf = nullptr;
-        //std::cout << "contig_span:    " << contiguous_span << std::endl;
-        //std::cout << "total_span:     " << total_span << std::endl;
-        //std::cout << "new_span:       " << new_span << std::endl;
-        //std::cout << "new_ghost_span: " << new_ghost_span << std::endl;
-        //std::cout << "new_nringlet:   " << new_nringlet << std::endl;
-        //std::cout << "new_stride:     " << new_stride << std::endl;
         //std::cout << "Allocating " << new_nbyte << std::endl;
-        RB_ASSERT_EXCEPTION(memory::malloc_((void**)&new_buf, new_nbyte, state.space) == RBStatus::STATUS_SUCCESS,
-                            RBStatus::STATUS_MEM_ALLOC_FAILED);
+        info->buf = _allocate_buffer(info->ghost_span, info->span, info->stride, info->nringlet, &info->hugepages);
+        state::RingCounters::add(state.counters.reallocs, 1);
+        info->numa_nodes = _place_buffer(info->buf, info->stride, info->nringlet);
+        // Large host rings split first-touch and migration across worker threads
+        bool host     = (state.space != RBSpace::SPACE_CUDA &&
+                         state.space != RBSpace::SPACE_CUDA_MANAGED);
+        thread_cores->clear();
+        if( host && state.resize_nthread > 1 ) {
+            *thread_cores = _resize_thread_cores(info->numa_nodes.empty() ? -1 : info->numa_nodes.front());
+        }
+        if( state.prefault ) {
+            // Fault the pages in now rather than in the writer's first lap, after the NUMA
+            //   policy is set and on the ring's core so first-touch places them there as well
+            RBStatus status = !thread_cores->empty() ?
+                memory::prefaultParallel(info->buf, new_nbyte, thread_cores->size(), thread_cores->data()) :
+                memory::prefault(info->buf, new_nbyte, state.core);
+            RB_ASSERT_EXCEPTION(status == RBStatus::STATUS_SUCCESS, RBStatus::STATUS_INVALID_ARGUMENT);
+        }
+        info->memlocked = false;
+        if( state.memlock ) {
+            info->memlocked = (memory::lockMemory(info->buf, new_nbyte) == RBStatus::STATUS_SUCCESS);
+            if( !info->memlocked ) {
+                spdlog::warn("Ringbuffer[{0}] cannot lock {1} bytes into memory, check RLIMIT_MEMLOCK", state.name, new_nbyte);
+            }
+        }
+    }
+
+    bool Ring::_incremental_resize_possible(std::size_t nringlet) const {
+        const auto& state = get_state();
+        // Note: The spsc fast path uses the buffer without the mutex, so it cannot be swapped under it
+        return (state.incremental_resize && state.buf && !state.spsc && !state.mirrored && !state.shm &&
+                state.space == RBSpace::SPACE_SYSTEM && nringlet <= state.nringlet);
+    }
+
+    void Ring::_resize_incremental(state::unique_lock_type& lock, state::BufferInfo info) {
+        auto& state = get_state();
+        if( state.migrate_thread.joinable() ) {
+            // Note: The thread of the previous resize does not take the mutex after it is done
+            state.migrate_thread.join();
+        }
+        // The new buffer is prepared without the mutex while the ring keeps running on the current one
+        state.migrating = true;
+        std::vector<int> thread_cores;
+        lock.unlock();
+        try {
+            this->_prepare_buffer(&info, &thread_cores);
+        } catch( ... ) {
+            lock.lock();
+            state.migrating = false;
+            state.realloc_condition.notify_all();
+            throw;
+        }
+        lock.lock();
+
+        // Spans open now stay in the old buffer, everything reserved from here on goes to the new one
+        state.old_buffer.buf        = state.buf;
+        state.old_buffer.ghost_span = state.ghost_span;
+        state.old_buffer.span       = state.span;
+        state.old_buffer.stride     = state.stride;
+        state.old_buffer.nringlet   = state.nringlet;
+        state.old_buffer.offset0    = state.offset0;
+        state.old_buffer.hugepages  = state.buf_hugepages;
+        state.old_buffer.memlocked  = state.buf_memlocked;
+        state.old_nopen        = state.nread_open + state.nwrite_open;
+        state.old_head         = state.head;
+        state.old_reserve_head = state.reserve_head;
+        state.migrate_copied    = state.tail;
+        state.migrate_copy_end  = state.tail;
+        state.migrate_copy_done = false;
+
+        state.buf        = info.buf;
+        state.buf_hugepages = info.hugepages;
+        state.buf_memlocked = info.memlocked;
+        state.buf_numa_nodes = info.numa_nodes;
+        state.ghost_span = info.ghost_span;
+        state.span       = info.span;
+        state.stats_span = info.span;
+        state.stride     = info.stride;
+        state.ghost_dirty_beg = 0;
+        RB_PROBE4(resize, state.name.c_str(), state.ghost_span, state.span, state.nringlet);
+        this->_update_proclog_static();
+
+        state.migrate_thread = std::thread([this, thread_cores]() {
+            this->_migrate_old_buffer(thread_cores);
+        });
+    }
+
+    void Ring::_migrate_old_buffer(std::vector<int> thread_cores) {
+        auto& state = get_state();
+        state::unique_lock_type lock(state.mutex);
+        while( true ) {
+            // Data the tail has passed does not have to be copied any more
+            std::size_t begin = state.migrate_copied;
+            if( delta_type(state.tail - begin) > 0 ) {
+                begin = state.tail;
+            }
+            if( delta_type(state.old_head - begin) <= 0 ) {
+                break;
+            }
+            std::size_t end = begin + std::min(std::size_t(RINGBUFFER_MIGRATE_CHUNK_SIZE), std::size_t(state.old_head - begin));
+            state.migrate_copied   = begin;
+            state.migrate_copy_end = end;
+            lock.unlock();
+            this->_copy_from_old_buffer(begin, end, thread_cores);
+            lock.lock();
+            state.migrate_copied = end;
+            ++state.wait_events;
+            state.read_waiters.notify_all();
+            state.write_condition.notify_all();
+        }
+        state.migrate_copied    = state.old_head;
+        state.migrate_copy_end  = state.old_head;
+        state.migrate_copy_done = true;
+        ++state.wait_events;
+        state.read_waiters.notify_all();
+        state.write_condition.notify_all();
+        this->_free_old_buffer_if_done();
+    }
+
+    void Ring::_copy_from_old_buffer(std::size_t begin, std::size_t end, const std::vector<int>& thread_cores) {
+        auto& state = get_state();
+        const auto& old = state.old_buffer;
+        // Note: Neither geometry changes while the old buffer is alive
+        while( begin != end ) {
+            std::size_t src  = _old_buf_offset(begin);
+            std::size_t dst  = _buf_offset(begin);
+            std::size_t size = std::min({std::size_t(end - begin), old.span - src, state.span - dst});
+            if( !thread_cores.empty() ) {
+                memory::memcpy2DParallel(state.buf + dst, state.stride, old.buf + src, old.stride, size, state.nringlet,
+                                         thread_cores.size(), thread_cores.data(), true);
+            } else {
+                memory::memcpy2DNonTemporal(state.buf + dst, state.stride, old.buf + src, old.stride, size, state.nringlet);
+            }
+            begin += size;
+        }
+    }
+
+    void Ring::_copy_span_from_old_buffer(std::size_t origin, std::size_t begin, std::size_t size) {
+        auto& state = get_state();
+        const auto& old = state.old_buffer;
+        // Note: The span is contiguous in both buffers, it may extend into their ghost regions
+        std::size_t offset = begin - origin;
+        memory::memcpy2D(state.buf + _buf_offset(origin) + offset, state.stride, state.space,
+                         old.buf + _old_buf_offset(origin) + offset, old.stride, state.space,
+                         size, state.nringlet);
+    }
+
+    std::size_t Ring::_old_buf_offset(std::size_t offset) const {
+        const auto& old = get_state().old_buffer;
+        return (offset - old.offset0) % old.span;
+    }
+
+    bool Ring::_old_write_span(std::size_t origin) const {
+        const auto& state = get_state();
+        if( !state.old_buffer.buf || delta_type(origin - state.old_reserve_head) >= 0 ) {
+            return false;
+        }
+        return (std::find(state.late_reservations.begin(), state.late_reservations.end(), origin) ==
+                state.late_reservations.end());
+    }
+
+    bool Ring::_in_old_buffer(const void* data) const {
+        const auto& state = get_state();
+        const auto& old = state.old_buffer;
+        return (old.buf && data >= old.buf && data < old.buf + old.stride*old.nringlet);
+    }
+
+    void Ring::_close_old_span(bool in_old_buffer) {
+        auto& state = get_state();
+        if( !state.old_buffer.buf ) {
+            return;
+        }
+        if( in_old_buffer && state.old_nopen ) {
+            --state.old_nopen;
+        }
+        this->_free_old_buffer_if_done();
+    }
+
+    void Ring::_free_old_buffer_if_done() {
+        auto& state = get_state();
+        auto& old = state.old_buffer;
+        if( !old.buf || !state.migrate_copy_done ) {
+            return;
+        }
+        // Note: Once no span is open at all none can refer to the old buffer, even if
+        //         some were released without their data pointer
+        if( state.old_nopen && (state.nread_open || state.nwrite_open) ) {
+            return;
+        }
+        _free_buffer(old.buf, old.span, old.stride, old.nringlet, old.hugepages, old.memlocked);
+        old = state::BufferInfo();
+        state.old_nopen = 0;
+        state.late_reservations.clear();
+        state.migrating = false;
+        state.realloc_condition.notify_all();
+    }
+
+    bool Ring::_migration_covers(std::size_t begin, std::size_t end) const {
+        const auto& state = get_state();
+        if( !state.old_buffer.buf || state.migrate_copy_done ) {
+            return true;
+        }
+        std::size_t tail = state.tail;
+        if( delta_type(begin - tail) < 0 ) {
+            begin = tail;
+        }
+        if( delta_type(begin - state.old_head) >= 0 ) {
+            // Written to the new buffer or copied there when committed
+            return true;
+        }
+        std::size_t needed = (delta_type(end - state.old_head) < 0) ? end : state.old_head;
+        return (delta_type(state.migrate_copied - needed) >= 0);
+    }
+
+    bool Ring::_migration_allows(std::size_t reserve_head) const {
+        const auto& state = get_state();
+        if( !state.old_buffer.buf || state.migrate_copied == state.migrate_copy_end ) {
+            return true;
+        }
+        // The tail must not pass the chunk that is being copied, its place in the buffer would be reused
+        return (delta_type(reserve_head - state.span - state.migrate_copied) <= 0);
+    }
+
+    std::size_t Ring::span_stride(const void* data) const {
+        const auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        return this->_in_old_buffer(data) ? state.old_buffer.stride : state.stride;
+    }
+
+    void Ring::set_incremental_resize(bool enabled) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        RB_ASSERT_EXCEPTION(!enabled || state.space == RBSpace::SPACE_SYSTEM, RBStatus::STATUS_UNSUPPORTED_SPACE);
+        state.incremental_resize = enabled;
+    }
+
+    bool Ring::resize_pending() const {
+        const auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        return (state.old_buffer.buf != nullptr);
+    }
+
+    RingReclaim Ring::shrink(std::size_t contiguous_span, std::size_t total_span) {
+        RB_TRACE();
+        RB_ASSERT_EXCEPTION(contiguous_span <= total_span, RBStatus::STATUS_INVALID_ARGUMENT);
+        auto& state = get_state();
+        state::unique_lock_type lock(state.mutex);
+        RB_ASSERT_EXCEPTION(!state.shm_attached, RBStatus::STATUS_INVALID_STATE);
+        // Other processes may have the segment mapped, so it cannot be reallocated
+        RB_ASSERT_EXCEPTION(!state.shm, RBStatus::STATUS_UNSUPPORTED);
+        RingReclaim result;
+        if( !state.buf ) {
+            return result;
+        }
+
+        state::realloc_lock_type realloc_lock(lock, this);
+        // The pages of the current buffer may still be moving, or an incremental resize may
+        //   still hold the previous buffer
+        state.realloc_condition.wait(lock, [&state]() {
+            return !state.migrating;
+        });
+        result.resident_before = this->_resident_size();
+        result.resident_after  = result.resident_before;
+
+        // Data a guarantee still protects must fit into the new buffer
+        std::size_t head = state.head;
+        total_span = std::max(total_span, std::size_t(head - this->_earliest_guarantee()));
+        state::BufferInfo info = this->_buffer_geometry(contiguous_span, total_span, state.nringlet);
+        if( info.stride >= state.stride ) {
+            return result;
+        }
+
+        std::vector<int> thread_cores;
+        this->_prepare_buffer(&info, &thread_cores);
+        std::size_t new_tail = head - std::min(std::size_t(head - state.tail), info.span);
+        result.bytes_dropped = this->_drop_to(new_tail);
+
+        // The newest data goes to the front of the new buffer, so it does not wrap there
+        for( std::size_t begin=new_tail; begin!=head; ) {
+            std::size_t src  = _buf_offset(begin);
+            std::size_t size = std::min(std::size_t(head - begin), state.span - src);
+            memory::memcpy2D(info.buf + (begin - new_tail), info.stride, state.space,
+                             state.buf + src, state.stride, state.space,
+                             size, state.nringlet);
+            begin += size;
+        }
+        cuda::streamSynchronize();
+        _free_buffer(state.buf, state.span, state.stride, state.nringlet, state.buf_hugepages, state.buf_memlocked);
+
+        state.buf        = info.buf;
+        state.buf_hugepages = info.hugepages;
+        state.buf_memlocked = info.memlocked;
+        state.buf_numa_nodes = info.numa_nodes;
+        state.ghost_span = info.ghost_span;
+        state.span       = info.span;
+        state.stats_span = info.span;
+        state.stride     = info.stride;
+        state.offset0    = new_tail;
+        state.ghost_dirty_beg = 0;
+        RB_PROBE4(resize, state.name.c_str(), state.ghost_span, state.span, state.nringlet);
+        this->_update_proclog_static();
+
+        result.resident_after = this->_resident_size();
+        return result;
+    }
+
+    RingReclaim Ring::reclaim_idle() {
+        RB_TRACE();
+        auto& state = get_state();
+        RB_ASSERT_EXCEPTION(state.space == RBSpace::SPACE_SYSTEM, RBStatus::STATUS_UNSUPPORTED_SPACE);
+        state::lock_guard_type lock(state.mutex);
+        return this->_reclaim_idle();
+    }
+
+    void Ring::set_idle_reclaim(std::chrono::milliseconds idle_after) {
+        auto& state = get_state();
+        RB_ASSERT_EXCEPTION(idle_after.count() >= 0, RBStatus::STATUS_INVALID_ARGUMENT);
+        RB_ASSERT_EXCEPTION(idle_after.count() == 0 || state.space == RBSpace::SPACE_SYSTEM,
+                            RBStatus::STATUS_UNSUPPORTED_SPACE);
+        state::unique_lock_type lock(state.mutex);
+        this->_stop_idle_reclaim(lock);
+        state.idle_after = idle_after;
+        if( idle_after.count() > 0 ) {
+            state.idle_stop   = false;
+            state.idle_thread = std::thread([this]() {
+                this->_idle_reclaim_loop();
+            });
+        }
+    }
+
+    std::size_t Ring::resident_size() const {
+        const auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        return this->_resident_size();
+    }
+
+    std::size_t Ring::_earliest_guarantee() {
+        auto& state = get_state();
+        std::size_t head = state.head;
+        std::size_t earliest = head;
+        {
+            auto& guarantees = this->_guarantee_table();
+            GuaranteeLock lk(state);
+            if( !guarantees.empty() ) {
+                earliest = guarantees.recompute_earliest(head);
+            }
+        }
+        std::size_t tail = state.tail;
+        return (delta_type(earliest - tail) < 0) ? tail : earliest;
+    }
+
+    std::size_t Ring::_drop_to(std::size_t new_tail) {
+        auto& state = get_state();
+        std::size_t tail = state.tail;
+        if( delta_type(new_tail - tail) <= 0 ) {
+            return 0;
+        }
+        RB_PROBE3(tail_pull, state.name.c_str(), tail, new_tail);
+        state.tail = new_tail;
+        this->_discard_old_sequences();
+        return std::size_t(new_tail - tail);
+    }
+
+    std::size_t Ring::_resident_size() const {
+        const auto& state = get_state();
+        if( !state.buf || (state.space != RBSpace::SPACE_SYSTEM && state.space != RBSpace::SPACE_SHM) ) {
+            return 0;
+        }
+        std::size_t nresident = 0;
+        if( state.mirrored ) {
+            // Count the pages of each ringlet once, not also through its mirror
+            for( std::size_t i=0; i<state.nringlet; ++i ) {
+                std::size_t ringlet = 0;
+                RB_ASSERT_EXCEPTION(memory::getResidentSize(state.buf + i*state.stride, state.span, &ringlet) ==
+                                    RBStatus::STATUS_SUCCESS, RBStatus::STATUS_MEM_OP_FAILED);
+                nresident += ringlet;
+            }
+        } else {
+            RB_ASSERT_EXCEPTION(memory::getResidentSize(state.buf, state.stride*state.nringlet, &nresident) ==
+                                RBStatus::STATUS_SUCCESS, RBStatus::STATUS_MEM_OP_FAILED);
+        }
+        const auto& old = state.old_buffer;
+        if( old.buf ) {
+            std::size_t old_resident = 0;
+            RB_ASSERT_EXCEPTION(memory::getResidentSize(old.buf, old.stride*old.nringlet, &old_resident) ==
+                                RBStatus::STATUS_SUCCESS, RBStatus::STATUS_MEM_OP_FAILED);
+            nresident += old_resident;
+        }
+        return nresident;
+    }
+
+    bool Ring::_idle_reclaim_possible() const {
+        const auto& state = get_state();
+        // Open spans (and the spsc fast path) use the buffer without the mutex, and locked pages
+        //   cannot be discarded
+        return (state.buf && state.space == RBSpace::SPACE_SYSTEM && !state.spsc && !state.buf_memlocked &&
+                !state.migrating && state.nread_open == 0 && state.nwrite_open == 0 &&
+                state.nrealloc_pending == 0);
+    }
+
+    RingReclaim Ring::_reclaim_idle() {
+        auto& state = get_state();
+        RingReclaim result;
+        result.resident_before = this->_resident_size();
+        result.resident_after  = result.resident_before;
+        if( !this->_idle_reclaim_possible() ) {
+            return result;
+        }
+        // Only the free space [head, tail + span) of each ringlet goes, the tail stays where it
+        //   is and every reader can still read what it could before. The ghost region follows the
+        //   front of the buffer it mirrors.
+        std::size_t head = state.head;
+        std::size_t size = head - state.tail;
+        if( size >= state.span ) {
+            return result;
+        }
+        std::size_t nringlet = state.nringlet;
+        std::vector<std::pair<std::size_t, std::size_t>> unused;
+        if( size == 0 && !state.mirrored ) {
+            // The ringlets are contiguous, so the whole buffer goes at once
+            unused.emplace_back(0, state.stride*state.nringlet);
+            nringlet = 1;
+        } else if( size == 0 ) {
+            unused.emplace_back(0, state.span);
+        } else {
+            std::size_t beg = _buf_offset(head);
+            std::size_t end = beg + (state.span - size);
+            if( end <= state.span ) {
+                unused.emplace_back(beg, end);
+            } else {
+                unused.emplace_back(beg, state.span);
+                unused.emplace_back(0, end - state.span);
+            }
+            if( !state.mirrored ) {
+                std::size_t nghost = unused.size();
+                for( std::size_t i=0; i<nghost; ++i ) {
+                    std::size_t ghost_end = std::min(unused[i].second, state.ghost_span);
+                    if( unused[i].first < ghost_end ) {
+                        unused.emplace_back(state.span + unused[i].first, state.span + ghost_end);
+                    }
+                }
+            }
+        }
+        // Note: Explicit huge pages can only be discarded as a whole, transparent ones are split
+        std::size_t page_size = (state.buf_hugepages == RBHugePages::HUGEPAGES_2MB ||
+                                 state.buf_hugepages == RBHugePages::HUGEPAGES_1GB) ?
+                                memory::getHugePageSize(state.buf_hugepages) : memory::getPageSize();
+        for( std::size_t i=0; i<nringlet; ++i ) {
+            for( const auto& range : unused ) {
+                if( range.first >= range.second ) {
+                    continue;
+                }
+                RBStatus status = memory::discardMemory(state.buf + i*state.stride + range.first,
+                                                        range.second - range.first, page_size, state.mirrored);
+                RB_ASSERT_EXCEPTION(status == RBStatus::STATUS_SUCCESS, status);
+            }
+        }
+        result.resident_after = this->_resident_size();
+        return result;
+    }
+
+    void Ring::_idle_reclaim_loop() {
+        auto& state = get_state();
+        state::unique_lock_type lock(state.mutex);
+        std::size_t last_head = state.head;
+        bool reclaimed = false;
+        while( true ) {
+            state.idle_condition.wait_for(lock, state.idle_after, [&state]() {
+                return state.idle_stop;
+            });
+            if( state.idle_stop ) {
+                break;
+            }
+            std::size_t head = state.head;
+            if( head != last_head || state.reserve_head != head ) {
+                // Busy, the idle time starts again
+                last_head = head;
+                reclaimed = false;
+                continue;
+            }
+            if( reclaimed || !this->_idle_reclaim_possible() ) {
+                continue;
+            }
+            reclaimed = true;
+            try {
+                RingReclaim result = this->_reclaim_idle();
+                if( result.resident_after != result.resident_before ) {
+                    spdlog::info("Ringbuffer[{0}] idle for {1}ms, resident {2} -> {3} bytes",
+                                 state.name, state.idle_after.count(), result.resident_before,
+                                 result.resident_after);
+                }
+            } catch( const RBException& e ) {
+                spdlog::warn("Ringbuffer[{0}] idle reclaim failed: {1}", state.name, e.what());
+            }
+        }
+    }
+
+    void Ring::_stop_idle_reclaim(state::unique_lock_type& lock) {
+        auto& state = get_state();
+        while( state.idle_thread.joinable() ) {
+            std::thread thread = std::move(state.idle_thread);
+            state.idle_stop = true;
+            state.idle_condition.notify_all();
+            lock.unlock();
+            thread.join();
+            lock.lock();
+        }
+    }
+
+    pointer Ring::_allocate_buffer(std::size_t ghost_span, std::size_t span, std::size_t stride, std::size_t nringlet,
+                                   RBHugePages* hugepages) {
+        auto& state = get_state();
+        pointer buf = nullptr;
+        *hugepages = RBHugePages::HUGEPAGES_NONE;
+        if( state.space == RBSpace::SPACE_SHM ) {
+            RBStatus status = shm::create(state.name, span, ghost_span, nringlet, &state.shm_segment);
+            // Note: STATUS_RING_NOT_AVAILABLE if a live process already owns the name
+            RB_ASSERT_EXCEPTION(status == RBStatus::STATUS_SUCCESS, status);
+            state.shm = state.shm_segment.header;
+            state.stats_shm = state.shm;
+            buf = state.shm_segment.data;
+        } else if( state.mirrored ) {
+            RB_ASSERT_EXCEPTION(stride == 2*span, RBStatus::STATUS_INTERNAL_ERROR);
+            RB_ASSERT_EXCEPTION(memory::mallocMirrored((void**)&buf, span, nringlet) == RBStatus::STATUS_SUCCESS,
+                                RBStatus::STATUS_MEM_ALLOC_FAILED);
+        } else if( state.hugepages != RBHugePages::HUGEPAGES_NONE ) {
+            RB_ASSERT_EXCEPTION(memory::mallocHuge((void**)&buf, stride*nringlet, state.hugepages, hugepages) == RBStatus::STATUS_SUCCESS,
+                                RBStatus::STATUS_MEM_ALLOC_FAILED);
+        } else {
+            RB_ASSERT_EXCEPTION(memory::malloc_((void**)&buf, stride*nringlet, state.space) == RBStatus::STATUS_SUCCESS,
+                                RBStatus::STATUS_MEM_ALLOC_FAILED);
+        }
+        return buf;
+    }
+
+    void Ring::_free_buffer(pointer buf, std::size_t span, std::size_t stride, std::size_t nringlet, RBHugePages hugepages,
+                            bool memlocked) {
+        auto& state = get_state();
+        if( memlocked ) {
+            memory::unlockMemory(buf, stride*nringlet);
+        }
+        if( state.mirrored ) {
+            memory::freeMirrored(buf, span, nringlet);
+        } else if( hugepages != RBHugePages::HUGEPAGES_NONE ) {
+            memory::freeHuge(buf, stride*nringlet, hugepages);
+        } else {
+            memory::free_(buf, state.space);
+        }
+    }
+
+    void Ring::set_mirrored(bool enabled) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        RB_ASSERT_EXCEPTION(!state.buf, RBStatus::STATUS_INVALID_STATE);
+        if( state.space == RBSpace::SPACE_SHM ) {
+            RB_ASSERT_EXCEPTION(enabled, RBStatus::STATUS_UNSUPPORTED_SPACE);
+        }
+        RB_ASSERT_EXCEPTION(!enabled || state.space == RBSpace::SPACE_SYSTEM ||
+                            state.space == RBSpace::SPACE_SHM, RBStatus::STATUS_UNSUPPORTED_SPACE);
+        RB_ASSERT_EXCEPTION(!enabled || state.hugepages == RBHugePages::HUGEPAGES_NONE, RBStatus::STATUS_UNSUPPORTED);
+        state.mirrored = enabled;
+    }
+
+    void Ring::set_prefault(bool enabled) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        RB_ASSERT_EXCEPTION(!enabled || state.space == RBSpace::SPACE_SYSTEM ||
+                            state.space == RBSpace::SPACE_SHM, RBStatus::STATUS_UNSUPPORTED_SPACE);
+        state.prefault = enabled;
+    }
+
+    void Ring::set_memlock(bool enabled) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        RB_ASSERT_EXCEPTION(!enabled || state.space == RBSpace::SPACE_SYSTEM ||
+                            state.space == RBSpace::SPACE_SHM, RBStatus::STATUS_UNSUPPORTED_SPACE);
+        state.memlock = enabled;
+    }
+
+    void Ring::set_resize_threads(std::size_t nthread, const std::vector<int>& cores) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        RB_ASSERT_EXCEPTION(nthread > 0, RBStatus::STATUS_INVALID_ARGUMENT);
+        state.resize_nthread = nthread;
+        state.resize_cores   = cores;
+    }
+
+    std::vector<int> Ring::_resize_thread_cores(int node) const {
+        const auto& state = get_state();
+        std::vector<int> cores = state.resize_cores;
 #ifdef RINGBUFFER_WITH_NUMA
-        if( state.core != -1 ) {
-            RB_ASSERT_EXCEPTION(numa_available() != -1, RBStatus::STATUS_UNSUPPORTED);
-            int node = numa_node_of_cpu(state.core);
-            RB_ASSERT_EXCEPTION(node != -1, RBStatus::STATUS_INVALID_ARGUMENT);
-            numa_tonode_memory(new_buf, new_nbyte, node);
+        if( node == -1 && state.core != -1 && numa_available() != -1 ) {
+            node = numa_node_of_cpu(state.core);
+        }
+        if( cores.empty() && node != -1 ) {
+            // Keep the workers on the node the buffer is bound to
+            struct bitmask* cpus = numa_allocate_cpumask();
+            if( numa_node_to_cpus(node, cpus) == 0 ) {
+                for( unsigned int cpu=0; cpu<cpus->size; ++cpu ) {
+                    if( numa_bitmask_isbitset(cpus, cpu) ) {
+                        cores.push_back(int(cpu));
+                    }
+                }
+            }
+            numa_free_cpumask(cpus);
         }
+#else
+        (void)node;
 #endif
-        if( state.buf ) {
-            // Must move existing data and delete old buf
-            if( _buf_offset(state.tail) < _buf_offset(state.head) ) {
-                // Copy middle to beginning
-                memory::memcpy2D(new_buf, new_stride, state.space,
-                             state.buf + _buf_offset(state.tail), state.stride, state.space,
-                           std::size_t(state.head - state.tail), state.nringlet);
-                state.offset0 = state.tail;
+        if( cores.empty() ) {
+            cores.push_back(-1);
+        }
+        std::vector<int> thread_cores(state.resize_nthread);
+        for( std::size_t t=0; t<thread_cores.size(); ++t ) {
+            thread_cores[t] = cores[t % cores.size()];
+        }
+        return thread_cores;
+    }
+
+    std::vector<int> Ring::_place_buffer(pointer buf, std::size_t stride, std::size_t nringlet) {
+        auto& state = get_state();
+        std::vector<int> nodes(nringlet, -1);
+        if( state.space != RBSpace::SPACE_SYSTEM && state.space != RBSpace::SPACE_SHM ) {
+            return nodes;
+        }
+        std::size_t nbyte = stride*nringlet;
+        switch( state.numa_policy ) {
+            case RBNumaPolicy::NUMA_NONE: break;
+            case RBNumaPolicy::NUMA_CORE: {
+#ifdef RINGBUFFER_WITH_NUMA
+                if( state.core != -1 ) {
+                    int node = -1;
+                    RBStatus status = memory::getNumaNodeOfCore(state.core, &node);
+                    RB_ASSERT_EXCEPTION(status == RBStatus::STATUS_SUCCESS, status);
+                    RB_ASSERT_EXCEPTION(memory::bindToNumaNode(buf, nbyte, node) == RBStatus::STATUS_SUCCESS,
+                                        RBStatus::STATUS_MEM_OP_FAILED);
+                    std::fill(nodes.begin(), nodes.end(), node);
+                }
+#endif
+                break;
             }
-            else {
-                // Copy beg to beg and end to end, with larger gap between
-                memory::memcpy2D(new_buf, new_stride, state.space,
-                                 state.buf, state.stride, state.space,
-                           _buf_offset(state.head), state.nringlet);
+            case RBNumaPolicy::NUMA_NODE: {
+                int node = state.numa_nodes.front();
+                RB_ASSERT_EXCEPTION(memory::bindToNumaNode(buf, nbyte, node) == RBStatus::STATUS_SUCCESS,
+                                    RBStatus::STATUS_MEM_OP_FAILED);
+                std::fill(nodes.begin(), nodes.end(), node);
+                break;
+            }
+            case RBNumaPolicy::NUMA_INTERLEAVE: {
+                const int* node_list = state.numa_nodes.empty() ? nullptr : state.numa_nodes.data();
+                RB_ASSERT_EXCEPTION(memory::interleaveNumaNodes(buf, nbyte, node_list, state.numa_nodes.size())
+                                    == RBStatus::STATUS_SUCCESS, RBStatus::STATUS_MEM_OP_FAILED);
+                break;
+            }
+            case RBNumaPolicy::NUMA_RINGLETS: {
+                int nnode = 0;
+                if( state.numa_nodes.empty() ) {
+                    RB_ASSERT_EXCEPTION(memory::getNumaNodeCount(&nnode) == RBStatus::STATUS_SUCCESS,
+                                        RBStatus::STATUS_UNSUPPORTED);
+                }
+                for( std::size_t r=0; r<nringlet; ++r ) {
+                    nodes[r] = state.numa_nodes.empty() ? int(r % nnode) : state.numa_nodes[r % state.numa_nodes.size()];
+                    RB_ASSERT_EXCEPTION(memory::bindToNumaNode(buf + r*stride, stride, nodes[r]) == RBStatus::STATUS_SUCCESS,
+                                        RBStatus::STATUS_MEM_OP_FAILED);
+                }
+                break;
+            }
+        }
+        return nodes;
+    }
 
-                memory::memcpy2D(new_buf + (_buf_offset(state.tail)+(new_span-state.span)), new_stride, state.space,
-                                 state.buf + _buf_offset(state.tail), state.stride, state.space,
-                                 state.span - _buf_offset(state.tail), state.nringlet);
-                state.offset0 = state.head - _buf_offset(state.head); // @todo: Check this for sign/overflow issues
+    void Ring::set_numa_policy(RBNumaPolicy policy, const std::vector<int>& nodes) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        if( policy != RBNumaPolicy::NUMA_NONE && policy != RBNumaPolicy::NUMA_CORE ) {
+            RB_ASSERT_EXCEPTION(state.space == RBSpace::SPACE_SYSTEM ||
+                                state.space == RBSpace::SPACE_SHM, RBStatus::STATUS_UNSUPPORTED_SPACE);
+            int nnode = 0;
+            RB_ASSERT_EXCEPTION(memory::getNumaNodeCount(&nnode) == RBStatus::STATUS_SUCCESS,
+                                RBStatus::STATUS_UNSUPPORTED);
+            for( int node : nodes ) {
+                RB_ASSERT_EXCEPTION(node >= 0 && node < nnode, RBStatus::STATUS_INVALID_ARGUMENT);
             }
+        }
+        RB_ASSERT_EXCEPTION(policy != RBNumaPolicy::NUMA_NODE || nodes.size() == 1, RBStatus::STATUS_INVALID_ARGUMENT);
+        state.numa_policy = policy;
+        state.numa_nodes  = nodes;
+    }
 
-            // Copy old ghost region to new buffer
-            memory::memcpy2D(new_buf + new_span, new_stride, state.space,
-                             state.buf + state.span, state.stride, state.space,
-                             state.ghost_span, state.nringlet);
+    std::size_t Ring::migrate_to_node(int node, const migrate_progress_type& progress, std::size_t chunk_size) {
+        auto& state = get_state();
+        RB_ASSERT_EXCEPTION(chunk_size > 0, RBStatus::STATUS_INVALID_ARGUMENT);
+        pointer     buf   = nullptr;
+        std::size_t nbyte = 0;
+        {
+            state::lock_guard_type lock(state.mutex);
+            RB_ASSERT_EXCEPTION(state.space == RBSpace::SPACE_SYSTEM ||
+                                state.space == RBSpace::SPACE_SHM, RBStatus::STATUS_UNSUPPORTED_SPACE);
+            int nnode = 0;
+            RB_ASSERT_EXCEPTION(memory::getNumaNodeCount(&nnode) == RBStatus::STATUS_SUCCESS,
+                                RBStatus::STATUS_UNSUPPORTED);
+            RB_ASSERT_EXCEPTION(node >= 0 && node < nnode, RBStatus::STATUS_INVALID_ARGUMENT);
+            RB_ASSERT_EXCEPTION(!state.migrating, RBStatus::STATUS_INVALID_STATE);
+            // New reallocations go to node as well
+            state.numa_policy = RBNumaPolicy::NUMA_NODE;
+            state.numa_nodes  = {node};
+            if( !state.buf ) {
+                return 0;
+            }
+            state.migrating = true;
+            buf   = state.buf;
+            nbyte = state.stride*state.nringlet;
+        }
+        // Note: The buffer cannot be reallocated while migrating is set, so the pages are moved
+        //         without holding the mutex and spans stay open throughout
+        // Explicit huge pages can only be bound as a whole
+        chunk_size = util::round_up(chunk_size, memory::getHugePageSize(state.buf_hugepages));
+        std::size_t nmoved = 0;
+        RBStatus status = RBStatus::STATUS_SUCCESS;
+        for( std::size_t done=0; done<nbyte && status == RBStatus::STATUS_SUCCESS; ) {
+            std::size_t size = std::min(chunk_size, nbyte - done);
+            std::size_t chunk_moved = 0;
+            status = memory::migrateToNumaNode(buf + done, size, node, &chunk_moved);
+            done   += size;
+            nmoved += chunk_moved;
+            if( status == RBStatus::STATUS_SUCCESS && progress ) {
+                progress(done, nbyte, nmoved);
+            }
+        }
+        {
+            state::lock_guard_type lock(state.mutex);
+            state.migrating = false;
+            if( status == RBStatus::STATUS_SUCCESS ) {
+                std::fill(state.buf_numa_nodes.begin(), state.buf_numa_nodes.end(), node);
+            }
+            this->_update_proclog_static();
+        }
+        state.realloc_condition.notify_all();
+        RB_ASSERT_EXCEPTION(status == RBStatus::STATUS_SUCCESS, status);
+        return nmoved;
+    }
 
-            // Copy the part of the beg corresponding to the extra ghost space
-            memory::memcpy2D(new_buf + new_span + state.ghost_span, new_stride, state.space,
-                             state.buf + state.ghost_span, state.stride, state.space,
-                           std::min(new_ghost_span, state.span) - state.ghost_span, state.nringlet);
+    std::vector<int> Ring::cores_sharing_cache(int level) const {
+        const auto& state = get_state();
+        RB_ASSERT_EXCEPTION(state.core != -1, RBStatus::STATUS_INVALID_STATE);
+        std::vector<int> cores;
+        RBStatus status = affinity::topologyGetCacheCores(state.core, level, &cores);
+        RB_ASSERT_EXCEPTION(status == RBStatus::STATUS_SUCCESS, status);
+        return cores;
+    }
 
-            //_ghost_dirty = true; // @todo: Is this the right thing to do?
-            //_ghost_dirty_beg = new_ghost_span; // @todo: Is this the right thing to do?
-            state.ghost_dirty_beg = 0; // @todo: Is this the right thing to do?
-            memory::free_(state.buf, state.space);
-            cuda::streamSynchronize();
+    void Ring::set_hugepages(RBHugePages pages) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        if( pages != RBHugePages::HUGEPAGES_NONE ) {
+            RB_ASSERT_EXCEPTION(state.space == RBSpace::SPACE_SYSTEM, RBStatus::STATUS_UNSUPPORTED_SPACE);
+            RB_ASSERT_EXCEPTION(!state.mirrored, RBStatus::STATUS_UNSUPPORTED);
         }
-        state.buf        = new_buf;
-        state.ghost_span = new_ghost_span;
-        state.span       = new_span;
-        state.stride     = new_stride;
-        state.nringlet   = new_nringlet;
+        state.hugepages = pages;
+    }
+
+    void Ring::set_spsc(bool enabled) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        RB_ASSERT_EXCEPTION(!state.writing_begun, RBStatus::STATUS_INVALID_STATE);
+        RB_ASSERT_EXCEPTION(!state.shm_attached, RBStatus::STATUS_UNSUPPORTED);
+        RB_ASSERT_EXCEPTION(!state.migrating, RBStatus::STATUS_INVALID_STATE);
+        state.spsc = enabled;
+    }
+
+    void Ring::set_wait_policy(RBWaitPolicy policy, std::size_t spin_count) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        state.wait_policy = policy;
+        state.spin_count  = spin_count;
+    }
 
-        // @todo: Update the ProcLog entry for this ring
+    void Ring::set_notify_coalescing(std::size_t bytes, std::chrono::microseconds interval) {
+        auto& state = get_state();
+        // A byte threshold alone could hold back the last commits of a stalled writer forever
+        RB_ASSERT_EXCEPTION(bytes == 0 || interval.count() > 0, RBStatus::STATUS_INVALID_ARGUMENT);
+        state::lock_guard_type lock(state.mutex);
+        state.notify_bytes.store(bytes);
+        state.notify_interval_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count());
+        state.notified_head.store(state.head.load());
+        state.notified_time_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
     }
 
     void Ring::begin_writing() {
@@ -275,7 +1268,11 @@ namespace ringbuffer {
         state::lock_guard_type lock(state.mutex);
         RB_ASSERT_EXCEPTION(!state.writing_begun, RBStatus::STATUS_INVALID_STATE);
         RB_ASSERT_EXCEPTION(!state.writing_ended, RBStatus::STATUS_INVALID_STATE);
+        RB_ASSERT_EXCEPTION(!state.shm_attached,  RBStatus::STATUS_INVALID_STATE);
         state.writing_begun = true;
+        if( state.shm ) {
+            state.shm->writing_begun.store(1);
+        }
     }
 
     void Ring::end_writing() {
@@ -286,7 +1283,15 @@ namespace ringbuffer {
         // @todo: Assert that no sequences are open for writing
         state.writing_ended = true;
         state.eod = state.head;
+        ++state.wait_events;
         state.sequence_condition.notify_all();
+        // final flush of coalesced notifications
+        state.read_waiters.notify_all();
+        if( state.shm ) {
+            state.shm->eod.store(state.eod);
+            state.shm->writing_ended.store(1);
+            shm::notify(state.shm->read_event, state.shm->nread_waiting);
+        }
     }
 
     std::size_t Ring::_buf_offset(std::size_t offset) const {
@@ -299,13 +1304,38 @@ namespace ringbuffer {
         return state.buf + _buf_offset(offset);
     }
     
-    void Ring::_ghost_write(std::size_t offset, std::size_t span) {
-        auto& state = get_state();
+    bool Ring::_ghost_write_pending(std::size_t offset, std::size_t span, std::size_t origin) const {
+        const auto& state = get_state();
+        if( state.mirrored ) {
+            return false;
+        }
+        // Note: Relative to the buffer position of origin, so this may lie in the ghost region
+        std::size_t buf_offset_beg = _buf_offset(origin) + (offset - origin);
+        return (buf_offset_beg + span > state.span || buf_offset_beg < state.ghost_span);
+    }
+
+    bool Ring::_ghost_read_pending(std::size_t offset, std::size_t span) const {
+        if( get_state().mirrored ) {
+            return false;
+        }
         std::size_t buf_offset_beg = _buf_offset(offset);
         std::size_t buf_offset_end = _buf_offset(offset + span);
-        if( buf_offset_end < buf_offset_beg ) {
+        return (buf_offset_end < buf_offset_beg);
+    }
+
+    void Ring::_ghost_write(std::size_t offset, std::size_t span, std::size_t origin) {
+        auto& state = get_state();
+        if( state.mirrored ) {
+            // The mirror mapping makes the write visible in the ghost region already
+            return;
+        }
+        // Note: Relative to the buffer position of origin, so this may lie in the ghost region
+        std::size_t buf_offset_beg = _buf_offset(origin) + (offset - origin);
+        std::size_t buf_offset_end = buf_offset_beg + span;
+        if( buf_offset_end > state.span ) {
             // The write went into the ghost region, so copy to the ghosted part
-            this->_copy_from_ghost(0, buf_offset_end);
+            std::size_t ghost_beg = std::max(buf_offset_beg, state.span) - state.span;
+            this->_copy_from_ghost(ghost_beg, buf_offset_end - state.span - ghost_beg);
         }
         if( buf_offset_beg < (std::size_t)state.ghost_span ) {
             // The write touched the ghosted front of the buffer
@@ -315,6 +1345,9 @@ namespace ringbuffer {
     
     void Ring::_ghost_read(std::size_t offset, std::size_t span) {
         auto& state = get_state();
+        if( state.mirrored ) {
+            return;
+        }
         std::size_t buf_offset_beg = _buf_offset(offset);
         std::size_t buf_offset_end = _buf_offset(offset + span);
         if( buf_offset_end < buf_offset_beg ) {
@@ -332,6 +1365,8 @@ namespace ringbuffer {
     void Ring::_copy_to_ghost(std::size_t buf_offset, std::size_t span) {
         auto& state = get_state();
         // Copy from the front of the buffer to the ghost region at the end
+        RB_PROBE3(ghost_read, state.name.c_str(), buf_offset, span);
+        state::RingCounters::add(state.counters.ghost_bytes_read, span * state.nringlet);
         memory::memcpy2D(state.buf + (state.span + buf_offset), state.stride, state.space,
                    state.buf + buf_offset, state.stride, state.space,
                    span, state.nringlet);
@@ -342,6 +1377,8 @@ namespace ringbuffer {
     void Ring::_copy_from_ghost(std::size_t buf_offset, std::size_t span) {
         auto& state = get_state();
         // Copy from the ghost region to the front of the buffer
+        RB_PROBE3(ghost_write, state.name.c_str(), buf_offset, span);
+        state::RingCounters::add(state.counters.ghost_bytes_written, span * state.nringlet);
         memory::memcpy2D(state.buf + buf_offset, state.stride, state.space,
                          state.buf + (state.span + buf_offset), state.stride, state.space,
                          span, state.nringlet);
@@ -361,60 +1398,211 @@ namespace ringbuffer {
         //         siblings that would be too slow on their own. Is this actually
         //         a problem, and if so is there any way around it?
         state.reserve_head += size;
+        if( state.shm ) {
+            // Note: Published before the guarantees are checked, see _clamp_guarantee
+            state.shm->reserve_head.store(state.reserve_head);
+        }
         auto postcondition_predicate = [this]() {
             const auto& state = get_state();
-            bool no_guarantees;
-            {
-                std::scoped_lock<state::mutex_type> lk(state.guarantees_mutex);
-                no_guarantees = (state.guarantees.empty() || std::size_t(state.reserve_head - _get_earliest_guarantee()) <= state.span);
-            }
-            return (no_guarantees && state.nrealloc_pending == 0);
+            bool no_guarantees = this->_guarantees_allow(state.reserve_head);
+            return (no_guarantees && state.nrealloc_pending == 0 &&
+                    this->_migration_allows(state.reserve_head));
         };
 
+        RBStatus status = RBStatus::STATUS_SUCCESS;
         if( !nonblocking ) {
-            // either wait infinitely (timeout=0) or raise exception when timeout occurs
-            if (timeout.count() == 0) {
-                state.write_condition.wait(lock, postcondition_predicate);
-            } else {
-                if(!state.write_condition.wait_for(lock, timeout, postcondition_predicate)) {
-                    // Revert and return failure
-                    state.reserve_head -= size;
+            if( !postcondition_predicate() ) {
+                RB_PROBE3(reserve_wait_start, state.name.c_str(), size, state.reserve_head.load());
+                auto wait_begin = std::chrono::steady_clock::now();
+                // either wait infinitely (timeout=0) or raise exception when timeout occurs
+                status = this->_wait(lock, state.write_condition, &state.nwrite_waiting, timeout, postcondition_predicate);
+                auto waited = state::RingCounters::add_wait(state.counters.write_waits, state.counters.write_wait_ns, wait_begin);
+                RB_PROBE4(reserve_wait_end, state.name.c_str(), size, int(status), std::int64_t(waited.count()));
+                if( auto* histograms = state.histograms.load(std::memory_order_acquire) ) {
+                    histograms->reserve_wait.record(waited);
+                }
+            }
+        } else if( !postcondition_predicate() ) {
+            status = RBStatus::STATUS_WOULD_BLOCK;
+        }
+        if( status != RBStatus::STATUS_SUCCESS ) {
+            // Revert and return failure
+            state.reserve_head -= size;
+            if( state.shm ) {
+                state.shm->reserve_head.store(state.reserve_head);
+            }
+            return status;
+        }
+
+        std::size_t cur_span = state.reserve_head - state.tail;
+        if( cur_span > state.span ) {
+            // Pull the tail
+            RB_PROBE3(tail_pull, state.name.c_str(), state.tail.load(), state.tail + (cur_span - state.span));
+            state.tail += cur_span - state.span;
+            if( state.shm ) {
+                state.shm->tail.store(state.tail);
+            }
+            this->_discard_old_sequences();
+        }
+        return RBStatus::STATUS_SUCCESS;
+    }
+
+    void Ring::_discard_old_sequences() {
+        auto& state = get_state();
+        // Delete old sequences
+        while( !state.sequence_queue.empty() &&
+               //_sequence_queue.front()->_end != Sequence::RB_SEQUENCE_OPEN &&
+               state.sequence_queue.front()->is_finished() &&
+               //_sequence_queue.front()->_end <= _tail ) {
+               std::size_t(state.head - state.sequence_queue.front()->m_end) >= std::size_t(state.head - state.tail) ) {
+            RB_PROBE3(sequence_discard, state.name.c_str(), std::size_t(state.sequence_queue.front()->m_end),
+                      std::size_t(state.sequence_queue.front()->m_time_tag));
+            if( !state.sequence_queue.front()->m_name.empty() ) {
+                state.sequence_map.erase(state.sequence_queue.front()->m_name);
+            }
+            if( state.sequence_queue.front()->m_time_tag != std::size_t(-1) ) {
+                spdlog::trace("Ringbuffer[{0}] discard timetag: {1}", state.name, state.sequence_queue.front()->m_time_tag);
+                state.sequence_time_tag_map.erase(state.sequence_queue.front()->m_time_tag);
+            }
+            //delete _sequence_queue.front();
+            state.sequence_queue.pop();
+        }
+    }
+
+    RBStatus Ring::_wait(state::unique_lock_type& lock, state::condition_type& condition,
+                         std::atomic<std::size_t>* nwaiting,
+                         std::chrono::nanoseconds timeout, const std::function<bool()>& predicate) {
+        RB_TRACE();
+        auto& state = get_state();
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        if( state.wait_policy != RBWaitPolicy::WAIT_BLOCK ) {
+            // Spin phase: spin with the mutex released, polling only the atomic cursors and event
+            //   counters, and take the mutex again to check the predicate once one of them moved.
+            //   So spinners do not compete with the other side for the mutex. Spinning threads are
+            //   not counted as waiters, which keeps notifies (and the mutex) off the spsc fast path.
+            bool adaptive = (state.wait_policy == RBWaitPolicy::WAIT_ADAPTIVE);
+            std::size_t i = 0;
+            while( !adaptive || i < state.spin_count ) {
+                if( state.shm_attached ) {
+                    this->_shm_sync();
+                }
+                if( predicate() ) {
+                    return RBStatus::STATUS_SUCCESS;
+                }
+                if( timeout.count() != 0 && std::chrono::steady_clock::now() >= deadline ) {
+                    return RBStatus::STATUS_WAIT_TIMEOUT;
+                }
+                auto seen = this->_wait_snapshot();
+                lock.unlock();
+                do {
+                    if( state.wait_policy == RBWaitPolicy::WAIT_SPIN_YIELD && i >= state.spin_count ) {
+                        wait::yield();
+                    } else {
+                        wait::spin_pause();
+                    }
+                    ++i;
+                } while( this->_wait_snapshot() == seen && (!adaptive || i < state.spin_count) &&
+                         (timeout.count() == 0 || std::chrono::steady_clock::now() < deadline) );
+                lock.lock();
+            }
+            if( timeout.count() != 0 ) {
+                timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+                if( timeout.count() <= 0 ) {
+                    return (predicate() ? RBStatus::STATUS_SUCCESS : RBStatus::STATUS_WAIT_TIMEOUT);
+                }
+            }
+        }
+        ScopedWaiter waiter(nwaiting);
+        // Other processes cannot notify our conditions, so waits that depend on them
+        //   (everything for an attached ring, guarantees for the writing process)
+        //   use the event counters in the shared memory segment instead.
+        std::atomic<std::uint32_t>* event          = nullptr;
+        std::atomic<std::uint32_t>* nevent_waiting = nullptr;
+        if( state.shm && state.shm_attached ) {
+            event          = &state.shm->read_event;
+            nevent_waiting = &state.shm->nread_waiting;
+        } else if( state.shm && &condition == &state.write_condition ) {
+            event          = &state.shm->write_event;
+            nevent_waiting = &state.shm->nwrite_waiting;
+        }
+        if( !event ) {
+            if( timeout.count() == 0 ) {
+                condition.wait(lock, predicate);
+                return RBStatus::STATUS_SUCCESS;
+            }
+            return (condition.wait_for(lock, timeout, predicate) ?
+                    RBStatus::STATUS_SUCCESS : RBStatus::STATUS_WAIT_TIMEOUT);
+        }
+        while( true ) {
+            // Note: The event is read before the predicate, so a change in between
+            //         makes the wait below return immediately.
+            std::uint32_t expected = event->load();
+            if( state.shm_attached ) {
+                this->_shm_sync();
+            }
+            if( predicate() ) {
+                return RBStatus::STATUS_SUCCESS;
+            }
+            std::chrono::nanoseconds remaining(0);
+            if( timeout.count() != 0 ) {
+                remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+                if( remaining.count() <= 0 ) {
                     return RBStatus::STATUS_WAIT_TIMEOUT;
                 }
             }
-        } else if( !postcondition_predicate() ) {
-            // Revert and return failure
-            state.reserve_head -= size;
-            return RBStatus::STATUS_WOULD_BLOCK;
+            ++*nevent_waiting;
+            lock.unlock();
+            shm::wait(*event, expected, remaining);
+            lock.lock();
+            --*nevent_waiting;
         }
+    }
 
-        std::size_t cur_span = state.reserve_head - state.tail;
-        if( cur_span > state.span ) {
-            // Pull the tail
-            state.tail += cur_span - state.span;
-            // Delete old sequences
-            while( !state.sequence_queue.empty() &&
-                   //_sequence_queue.front()->_end != Sequence::RB_SEQUENCE_OPEN &&
-                   state.sequence_queue.front()->is_finished() &&
-                   //_sequence_queue.front()->_end <= _tail ) {
-                   std::size_t(state.head - state.sequence_queue.front()->m_end) >= std::size_t(state.head - state.tail) ) {
-                if( !state.sequence_queue.front()->m_name.empty() ) {
-                    state.sequence_map.erase(state.sequence_queue.front()->m_name);
-                }
-                if( state.sequence_queue.front()->m_time_tag != std::size_t(-1) ) {
-                    spdlog::trace("Ringbuffer[{0}] discard timetag: {1}", state.name, state.sequence_queue.front()->m_time_tag);
-                    state.sequence_time_tag_map.erase(state.sequence_queue.front()->m_time_tag);
+    std::array<std::size_t, 5> Ring::_wait_snapshot() const {
+        const auto& state = get_state();
+        if( state.shm ) {
+            // Note: The other side may be another process, it signals through the segment's events
+            const auto* shm = state.shm;
+            return {shm->head.load(), shm->tail.load(), shm->reserve_head.load(),
+                    (std::size_t(shm->read_event.load()) << 32) | shm->write_event.load(),
+                    state.wait_events.load(std::memory_order_relaxed)};
+        }
+        return {state.head.load(), state.tail.load(), state.reserve_head.load(), 0,
+                state.wait_events.load(std::memory_order_relaxed)};
+    }
+
+    RBStatus Ring::_wait_for_data(state::unique_lock_type& lock, state::condition_type& condition,
+                                  std::chrono::nanoseconds timeout, const std::function<bool()>& predicate) {
+        auto& state = get_state();
+        std::chrono::nanoseconds interval(state.notify_interval_ns.load(std::memory_order_relaxed));
+        if( interval.count() == 0 ) {
+            return this->_wait(lock, condition, &state.nread_waiting, timeout, predicate);
+        }
+        // Note: The writer may hold back the notification for data that is already committed,
+        //         so the wait is done in slices of the notify interval.
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while( true ) {
+            std::chrono::nanoseconds slice = interval;
+            if( timeout.count() != 0 ) {
+                auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+                if( remaining.count() <= 0 ) {
+                    return (predicate() ? RBStatus::STATUS_SUCCESS : RBStatus::STATUS_WAIT_TIMEOUT);
                 }
-                //delete _sequence_queue.front();
-                state.sequence_queue.pop();
+                slice = std::min(slice, remaining);
+            }
+            RBStatus status = this->_wait(lock, condition, &state.nread_waiting, slice, predicate);
+            if( status != RBStatus::STATUS_WAIT_TIMEOUT ) {
+                return status;
             }
         }
-        return RBStatus::STATUS_SUCCESS;
     }
 
     std::vector<uint64_t> Ring::list_time_tags() {
-        const auto& state = get_state();
+        auto& state = get_state();
         state::lock_guard_type lock(state.mutex);
+        if( state.shm_attached ) {
+            this->_shm_sync();
+        }
         std::vector<uint64_t> time_tags;
         for (auto& it : state.sequence_time_tag_map) {
             if (it.second->is_finished()) {
@@ -442,16 +1630,22 @@ namespace ringbuffer {
             RB_ASSERT_EXCEPTION(state.sequence_queue.empty() ||
                                 state.sequence_queue.back()->is_finished(),
                                 RBStatus::STATUS_INVALID_STATE);
+            // Attached rings can only be read from
+            RB_ASSERT_EXCEPTION(!state.shm_attached, RBStatus::STATUS_INVALID_STATE);
             std::size_t seq_begin = state.head + offset_from_head;
             // Cannot have existing sequence with same name
             RB_ASSERT_EXCEPTION(state.sequence_map.count(name)==0,              RBStatus::STATUS_INVALID_ARGUMENT);
             RB_ASSERT_EXCEPTION(state.sequence_time_tag_map.count(time_tag)==0, RBStatus::STATUS_INVALID_ARGUMENT);
             sequence.reset(new Sequence(shared_from_this(), name, time_tag, header_size,
                                         header, nringlet, seq_begin));
+            if( state.shm ) {
+                this->_shm_publish_sequence(sequence);
+            }
             if( state.sequence_queue.size() ) {
                 state.sequence_queue.back()->set_next(sequence);
             }
             state.sequence_queue.push(sequence);
+            ++state.wait_events;
             state.sequence_condition.notify_all();
             if( !std::string(name).empty() ) {
                 state.sequence_map.insert(std::make_pair(std::string(name),sequence));
@@ -481,6 +1675,9 @@ namespace ringbuffer {
         }
         auto& state = get_state();
         state::unique_lock_type lock(state.mutex);
+        if( state.shm_attached ) {
+            this->_shm_sync();
+        }
         SequencePtr sequence = this->_get_sequence_by_name(name);
         if( scoped_guarantee ) {
             // Move guarantee to start of sequence
@@ -522,6 +1719,9 @@ namespace ringbuffer {
         }
         auto& state = get_state();
         state::unique_lock_type lock(state.mutex);
+        if( state.shm_attached ) {
+            this->_shm_sync();
+        }
         SequencePtr sequence = this->_get_sequence_at(time_tag);
         if( scoped_guarantee ) {
             // Move guarantee to start of sequence
@@ -539,20 +1739,16 @@ namespace ringbuffer {
                 std::size_t(state.head - sequence->end()) <= std::size_t(state.head - state.tail));
     }
 
-    SequencePtr Ring::_get_earliest_or_latest_sequence(state::unique_lock_type& lock, bool latest, std::chrono::nanoseconds timeout) const {
-        const auto& state = get_state();
+    SequencePtr Ring::_get_earliest_or_latest_sequence(state::unique_lock_type& lock, bool latest, std::chrono::nanoseconds timeout) {
+        auto& state = get_state();
         // Wait until a sequence has been opened or writing has ended
         auto condition_predicate = [this]() {
             const auto& state = get_state();
             return !state.sequence_queue.empty() || state.writing_ended;
         };
         // either wait infinitely (timeout=0) or raise exception when timeout occurs
-        if (timeout.count() == 0) {
-            state.sequence_condition.wait(lock, condition_predicate);
-        } else {
-            if(!state.sequence_condition.wait_for(lock, timeout, condition_predicate)) {
-                throw RBException(RBStatus::STATUS_WAIT_TIMEOUT);
-            }
+        if( this->_wait(lock, state.sequence_condition, nullptr, timeout, condition_predicate) != RBStatus::STATUS_SUCCESS ) {
+            throw RBException(RBStatus::STATUS_WAIT_TIMEOUT);
         }
         RB_ASSERT_EXCEPTION(!(state.sequence_queue.empty() && !state.writing_ended), RBStatus::STATUS_INVALID_STATE);
         RB_ASSERT_EXCEPTION(!(state.sequence_queue.empty() &&  state.writing_ended), RBStatus::STATUS_END_OF_DATA);
@@ -575,23 +1771,29 @@ namespace ringbuffer {
         }
     }
 
-    SequencePtr Ring::_get_next_sequence(SequencePtr sequence,
-                                         state::unique_lock_type& lock, std::chrono::nanoseconds timeout) const {
-        const auto& state = get_state();
+    RBStatus Ring::_get_next_sequence(SequencePtr sequence, state::unique_lock_type& lock,
+                                      bool nonblocking, std::chrono::nanoseconds timeout, SequencePtr* next) {
+        auto& state = get_state();
         // Wait until the next sequence has been opened or writing has ended
         auto condition_predicate = [&]() {
             return ((bool)sequence->m_next) || state.writing_ended;
         };
-        // either wait infinitely (timeout=0) or raise exception when timeout occurs
-        if (timeout.count() == 0) {
-            state.sequence_condition.wait(lock, condition_predicate);
+        if( nonblocking ) {
+            if( !condition_predicate() ) {
+                return RBStatus::STATUS_WOULD_BLOCK;
+            }
         } else {
-            if(!state.sequence_condition.wait_for(lock, timeout, condition_predicate)) {
-                throw RBException(RBStatus::STATUS_WAIT_TIMEOUT);
+            // either wait infinitely (timeout=0) or return STATUS_WAIT_TIMEOUT
+            RBStatus status = this->_wait(lock, state.sequence_condition, nullptr, timeout, condition_predicate);
+            if( status != RBStatus::STATUS_SUCCESS ) {
+                return status;
             }
         }
-        RB_ASSERT_EXCEPTION(sequence->m_next, RBStatus::STATUS_END_OF_DATA);
-        return sequence->m_next;
+        if( !sequence->m_next ) {
+            return RBStatus::STATUS_END_OF_DATA;
+        }
+        *next = sequence->m_next;
+        return RBStatus::STATUS_SUCCESS;
     }
 
     SequencePtr Ring::open_earliest_or_latest_sequence(bool with_guarantee,
@@ -605,6 +1807,9 @@ namespace ringbuffer {
         }
         auto& state = get_state();
         state::unique_lock_type lock(state.mutex);
+        if( state.shm_attached ) {
+            this->_shm_sync();
+        }
         SequencePtr sequence = this->_get_earliest_or_latest_sequence(lock, latest, timeout);
         if( scoped_guarantee ) {
             // Move guarantee to start of sequence
@@ -623,8 +1828,16 @@ namespace ringbuffer {
         std::unique_ptr<state::Guarantee> scoped_guarantee = std::move(guarantee);
         auto& state = get_state();
         state::unique_lock_type lock(state.mutex);
-        //SequencePtr next_sequence = this->_get_next_sequence(sequence, lock);
-        sequence = this->_get_next_sequence(sequence, lock, timeout);
+        if( state.shm_attached ) {
+            this->_shm_sync();
+        }
+        SequencePtr next_sequence;
+        RBStatus status = this->_get_next_sequence(sequence, lock, false, timeout, &next_sequence);
+        if( status != RBStatus::STATUS_SUCCESS ) {
+            guarantee = std::move(scoped_guarantee);
+            throw RBException(status);
+        }
+        sequence = next_sequence;
         if( scoped_guarantee ) {
             // Move the guarantee to the start of the new sequence
             scoped_guarantee->move_nolock(
@@ -634,6 +1847,30 @@ namespace ringbuffer {
         guarantee = std::move(scoped_guarantee);
     }
 
+    RBStatus Ring::try_increment_sequence_to_next(SequencePtr& sequence,
+                                                  std::unique_ptr<state::Guarantee>& guarantee,
+                                                  bool nonblocking, std::chrono::nanoseconds timeout) {
+        // Note: Same as increment_sequence_to_next, but the sequence and guarantee are
+        //         left untouched if there is no next sequence (yet)
+        std::unique_ptr<state::Guarantee> scoped_guarantee = std::move(guarantee);
+        auto& state = get_state();
+        state::unique_lock_type lock(state.mutex);
+        if( state.shm_attached ) {
+            this->_shm_sync();
+        }
+        SequencePtr next_sequence;
+        RBStatus status = this->_get_next_sequence(sequence, lock, nonblocking, timeout, &next_sequence);
+        if( status == RBStatus::STATUS_SUCCESS ) {
+            sequence = next_sequence;
+            if( scoped_guarantee ) {
+                scoped_guarantee->move_nolock(
+                        this->_get_start_of_sequence_within_ring(sequence));
+            }
+        }
+        guarantee = std::move(scoped_guarantee);
+        return status;
+    }
+
 
 
     void Ring::finish_sequence(SequencePtr sequence,
@@ -646,12 +1883,18 @@ namespace ringbuffer {
             RB_ASSERT_EXCEPTION(!state.sequence_queue.empty() &&
                                 !state.sequence_queue.back()->is_finished(),
                                 RBStatus::STATUS_INVALID_STATE);
+            RB_ASSERT_EXCEPTION(!state.shm || footer_size <= RINGBUFFER_SHM_MAX_HEADER,
+                                RBStatus::STATUS_INSUFFICIENT_STORAGE);
             if (footer_size > 0) {
                 sequence->set_footer(footer_size, footer);
             }
             // This marks the sequence as finished
             sequence->m_end = state.head + offset_from_head;
-            state.read_condition.notify_all();
+            if( state.shm ) {
+                this->_shm_finish_sequence(sequence);
+            }
+            ++state.wait_events;
+            state.read_waiters.notify_all();
         }
         m_sequence_event.dispatch(sequence->time_tag());
     }
@@ -662,23 +1905,64 @@ namespace ringbuffer {
                             std::size_t*  begin_,
                             void**        data_,
                             std::chrono::nanoseconds timeout) {
-        RB_ASSERT_EXCEPTION(rsequence,             RBStatus::STATUS_INVALID_SEQUENCE_HANDLE);
-        RB_ASSERT_EXCEPTION(size_,                 RBStatus::STATUS_INVALID_POINTER);
-        RB_ASSERT_EXCEPTION(begin_,                RBStatus::STATUS_INVALID_POINTER);
-        RB_ASSERT_EXCEPTION(data_,                 RBStatus::STATUS_INVALID_POINTER);
+        RBStatus status = this->try_acquire_span(rsequence, offset, size_, begin_, data_, false, timeout);
+        if( status != RBStatus::STATUS_SUCCESS ) {
+            throw RBException(status);
+        }
+    }
+
+    RBStatus Ring::try_acquire_span(ReadSequence* rsequence,
+                                    std::size_t   offset, // Relative to sequence beg
+                                    std::size_t*  size_,
+                                    std::size_t*  begin_,
+                                    void**        data_,
+                                    bool          nonblocking,
+                                    std::chrono::nanoseconds timeout) {
+        RB_TRACE();
+#ifdef RINGBUFFER_WITH_USDT
+        const auto& state = get_state();
+        RB_PROBE3(acquire_span_entry, state.name.c_str(), offset, (size_ ? *size_ : 0));
+        RBStatus status = this->_try_acquire_span(rsequence, offset, size_, begin_, data_, nonblocking, timeout);
+        bool valid = (status == RBStatus::STATUS_SUCCESS);
+        RB_PROBE4(acquire_span_return, state.name.c_str(), (valid ? *begin_ : 0), (valid ? *size_ : 0), int(status));
+        return status;
+#else
+        return this->_try_acquire_span(rsequence, offset, size_, begin_, data_, nonblocking, timeout);
+#endif
+    }
+
+    RBStatus Ring::_try_acquire_span(ReadSequence* rsequence,
+                                     std::size_t   offset, // Relative to sequence beg
+                                     std::size_t*  size_,
+                                     std::size_t*  begin_,
+                                     void**        data_,
+                                     bool          nonblocking,
+                                     std::chrono::nanoseconds timeout) {
+        RB_ASSERT(rsequence,             RBStatus::STATUS_INVALID_SEQUENCE_HANDLE);
+        RB_ASSERT(size_,                 RBStatus::STATUS_INVALID_POINTER);
+        RB_ASSERT(begin_,                RBStatus::STATUS_INVALID_POINTER);
+        RB_ASSERT(data_,                 RBStatus::STATUS_INVALID_POINTER);
         // Cannot go back beyond the start of the sequence
-        RB_ASSERT_EXCEPTION(offset >= 0,     RBStatus::STATUS_INVALID_ARGUMENT);
-        SequencePtr sequence = rsequence->sequence();
+        RB_ASSERT(offset >= 0,     RBStatus::STATUS_INVALID_ARGUMENT);
         auto& state = get_state();
+        if( state.spsc && this->_acquire_span_spsc(rsequence, offset, size_, begin_, data_) ) {
+            return RBStatus::STATUS_SUCCESS;
+        }
+        SequencePtr sequence = rsequence->sequence();
         state::unique_lock_type lock(state.mutex);
-        RB_ASSERT_EXCEPTION(*size_ <= state.ghost_span, RBStatus::STATUS_INVALID_ARGUMENT);
+        if( state.shm_attached ) {
+            this->_shm_sync();
+        }
+        RB_ASSERT(*size_ <= state.ghost_span, RBStatus::STATUS_INVALID_ARGUMENT);
 
         std::size_t requested_begin = sequence->begin() + offset;
         std::size_t requested_end   = requested_begin + *size_;
 
         //Check, if we have not overwritten the requested sequence already
+        // Note: The sequence was overwritten
         if(requested_begin < state.tail){
-            throw RBException(RBStatus::STATUS_INVALID_SEQUENCE_HANDLE,"sequence was overwritten");
+            state::RingCounters::add(state.counters.bytes_overwritten, *size_);
+            return RBStatus::STATUS_INVALID_SEQUENCE_HANDLE;
         }
 
         // @todo: If this function fails, should the guarantee be left where it was?
@@ -706,73 +1990,144 @@ namespace ringbuffer {
         //   (meaning not overwritten and not past the end of the sequence).
         //   It will return a 0-length span if the requested span has been
         //     completely overwritten.
-        // It throws RBStatus::STATUS_END_OF_DATA if the requested span begins
+        // It returns RBStatus::STATUS_END_OF_DATA if the requested span begins
         //   after the end of the sequence.
 
         // Wait until requested span has been written or sequence has ended
 
         auto condition_predicate = [&]() {
             auto& state = get_state();
-            return ((delta_type(state.head - std::max(requested_begin, state.tail)) >=
-                     delta_type(requested_end - std::max(requested_begin, state.tail)) ||
+            std::size_t tail = state.tail;
+            return ((delta_type(state.head - std::max(requested_begin, tail)) >=
+                     delta_type(requested_end - std::max(requested_begin, tail)) ||
                      sequence->is_finished()) &&
-                    state.nrealloc_pending == 0);
+                    state.nrealloc_pending == 0 &&
+                    this->_migration_covers(requested_begin, requested_end));
         };
-        // either wait infinitely (timeout=0) or raise exception when timeout occurs
-        if (timeout.count() == 0) {
-            state.read_condition.wait(lock, condition_predicate);
-        } else {
-            if(!state.read_condition.wait_for(lock, timeout, condition_predicate)) {
-                throw RBException(RBStatus::STATUS_WAIT_TIMEOUT);
-                // @todo any cleanup needed ??
+        if( nonblocking ) {
+            if( !condition_predicate() ) {
+                return RBStatus::STATUS_WOULD_BLOCK;
+            }
+        } else if( !condition_predicate() ) {
+            auto wait_begin = std::chrono::steady_clock::now();
+            // Note: The reader registers the end of its span, so commits only wake it once
+            //         the span is complete (or the sequence ended)
+            ScopedReadWaiter waiter(state.read_waiters, requested_end);
+            // either wait infinitely (timeout=0) or return STATUS_WAIT_TIMEOUT
+            RBStatus status = this->_wait_for_data(lock, waiter.condition(), timeout, condition_predicate);
+            auto waited = state::RingCounters::add_wait(state.counters.read_waits, state.counters.read_wait_ns, wait_begin);
+            if( auto* histograms = state.histograms.load(std::memory_order_acquire) ) {
+                histograms->acquire_wait.record(waited);
+            }
+            if( status != RBStatus::STATUS_SUCCESS ) {
+                return status;
             }
         }
 
         // Constrain to what is in the buffer (i.e., what hasn't been overwritten)
-        std::size_t begin = std::max(requested_begin, state.tail);
+        std::size_t begin = std::max(requested_begin, state.tail.load());
         // Note: This results in size being 0 if the requested span has been
         //         completely overwritten.
         std::size_t   size  = std::max(delta_type(requested_end - begin), delta_type(0));
 
         if( sequence->is_finished() ) {
-            RB_ASSERT_EXCEPTION(begin < sequence->end(),
-                                RBStatus::STATUS_END_OF_DATA);
+            // Note: Not reported as an error, reaching the end is expected when polling
+            if( !(begin < sequence->end()) ) {
+                return RBStatus::STATUS_END_OF_DATA;
+            }
             size = std::min(size, std::size_t(sequence->end() - begin));
         }
         *begin_ = begin;
         *size_  = size;
+        state::RingCounters::add(state.counters.bytes_overwritten, begin - requested_begin);
+        state::RingCounters::add(state.counters.bytes_acquired, size);
+        state::RingCounters::add(state.counters.spans_acquired, 1);
+        if( size ) {
+            this->_record_acquire(begin + size);
+        }
 
         ++state.nread_open;
         _ghost_read(begin, size);
         *data_ = _buf_pointer(begin);
+        return RBStatus::STATUS_SUCCESS;
     }
 
     void Ring::release_span(ReadSequence* sequence,
                             std::size_t  begin,
-                            std::size_t  size) {
+                            std::size_t  size,
+                            const void*  data) {
+        RB_TRACE();
         auto& state = get_state();
+        RB_PROBE3(release_span, state.name.c_str(), begin, size);
+        if( state.spsc ) {
+            this->_close_span(state.nread_open);
+            return;
+        }
         state::unique_lock_type lock(state.mutex);
         --state.nread_open;
+        this->_close_old_span(data && this->_in_old_buffer(data));
         state.realloc_condition.notify_all();
     }
 
     void Ring::reserve_span(std::size_t size, std::size_t* begin, void** data, bool nonblocking, std::chrono::nanoseconds timeout) {
+        RBStatus status = this->try_reserve_span(size, begin, data, nonblocking, timeout);
+        if( status != RBStatus::STATUS_SUCCESS ) {
+            throw RBException(status);
+        }
+    }
+
+    RBStatus Ring::try_reserve_span(std::size_t size, std::size_t* begin, void** data, bool nonblocking, std::chrono::nanoseconds timeout) {
+        RB_TRACE();
         auto& state = get_state();
+        RB_PROBE2(reserve_span_entry, state.name.c_str(), size);
+        if( state.spsc && this->_reserve_span_spsc(size, begin, data) ) {
+            RB_PROBE4(reserve_span_return, state.name.c_str(), size, *begin, int(RBStatus::STATUS_SUCCESS));
+            return RBStatus::STATUS_SUCCESS;
+        }
         state::unique_lock_type lock(state.mutex);
-        RB_ASSERT_EXCEPTION(size <= state.ghost_span, RBStatus::STATUS_INVALID_ARGUMENT);
+        RB_ASSERT(!state.shm_attached, RBStatus::STATUS_INVALID_STATE);
+        RB_ASSERT(size <= state.ghost_span, RBStatus::STATUS_INVALID_ARGUMENT);
         *begin = state.reserve_head;
         auto ret = this->_advance_reserve_head(lock, size, nonblocking, timeout);
         if (ret != RBStatus::STATUS_SUCCESS) {
-            throw RBException(ret);
+            RB_PROBE4(reserve_span_return, state.name.c_str(), size, *begin, int(ret));
+            return ret;
         }
         ++state.nwrite_open;
         *data = _buf_pointer(*begin);
+        if( state.old_buffer.buf && delta_type(*begin - state.old_reserve_head) < 0 ) {
+            // An incremental resize swapped the buffer while this reservation waited for space,
+            //   unlike the spans that were open at the switch it was granted space in the new one
+            state.late_reservations.push_back(*begin);
+        }
+        RB_PROBE4(reserve_span_return, state.name.c_str(), size, *begin, int(RBStatus::STATUS_SUCCESS));
+        return RBStatus::STATUS_SUCCESS;
     }
 
     void Ring::commit_span(std::size_t begin, std::size_t reserve_size, std::size_t commit_size) {
+        this->_commit_span(begin, begin, reserve_size, commit_size);
+    }
+
+    void Ring::_commit_span(std::size_t origin, std::size_t begin, std::size_t reserve_size, std::size_t commit_size) {
+        RB_TRACE();
         auto& state = get_state();
+        RB_PROBE4(commit_span, state.name.c_str(), begin, reserve_size, commit_size);
+        if( state.spsc && this->_commit_span_spsc(origin, begin, reserve_size, commit_size) ) {
+            return;
+        }
         state::unique_lock_type lock(state.mutex);
-        _ghost_write(begin, commit_size);
+        // Spans reserved before an incremental resize were written to the old buffer
+        bool old_span = this->_old_write_span(origin);
+        if( !old_span ) {
+            auto late = std::find(state.late_reservations.begin(), state.late_reservations.end(), origin);
+            if( late != state.late_reservations.end() ) {
+                state.late_reservations.erase(late);
+            }
+        }
+        if( old_span && commit_size ) {
+            this->_copy_span_from_old_buffer(origin, begin, commit_size);
+        }
+        _ghost_write(begin, commit_size, origin);
 
         // @todo: Refactor/tidy this function a bit
 
@@ -785,7 +2140,15 @@ namespace ringbuffer {
             // This is the last-opened block so we can 'cancel' it by pulling back
             //   the reserve head.
             state.reserve_head = begin;
+            if( state.shm ) {
+                state.shm->reserve_head.store(state.reserve_head);
+            }
+            if( old_span ) {
+                // The next reservation goes to the new buffer
+                state.old_reserve_head = begin;
+            }
             --state.nwrite_open;
+            this->_close_old_span(old_span);
             state.realloc_condition.notify_all();
             return;
         }
@@ -803,7 +2166,13 @@ namespace ringbuffer {
         };
 
         // here we cannot add a timeout as we need to guarantee the writing of the data if started.
-        state.write_close_condition.wait(lock, condition_predicate);
+        if( !condition_predicate() ) {
+            auto wait_begin = std::chrono::steady_clock::now();
+            state.write_close_condition.wait(lock, condition_predicate);
+            if( auto* histograms = state.histograms.load(std::memory_order_acquire) ) {
+                histograms->commit_wait.record(std::chrono::steady_clock::now() - wait_begin);
+            }
+        }
 
         state.write_close_condition.notify_all();
 
@@ -821,12 +2190,586 @@ namespace ringbuffer {
             RB_ASSERT_EXCEPTION(false, RBStatus::STATUS_INVALID_STATE);
         }
         state.head += commit_size;
+        if( commit_size ) {
+            this->_record_commit(state.head);
+        }
+        state::RingCounters::add(state.counters.bytes_committed, commit_size);
+        state::RingCounters::add(state.counters.spans_committed, 1);
+        bool notify = commit_size && this->_notify_due(state.head);
+        if( state.shm ) {
+            state.shm->reserve_head.store(state.reserve_head);
+            state.shm->head.store(state.head);
+            if( notify ) {
+                shm::notify(state.shm->read_event, state.shm->nread_waiting);
+            }
+        }
 
-        state.read_condition.notify_all();
+        if( notify ) {
+            state.read_waiters.notify_until(state.head);
+        }
         --state.nwrite_open;
+        this->_close_old_span(old_span);
         state.realloc_condition.notify_all();
     }
 
+    void Ring::_publish_span(std::size_t origin, std::size_t begin, std::size_t size) {
+        RB_TRACE();
+        auto& state = get_state();
+        if( size == 0 ) {
+            return;
+        }
+        if( state.spsc && begin == state.head.load(std::memory_order_relaxed) ) {
+            if( this->_ghost_write_pending(begin, size, origin) ) {
+                state::lock_guard_type lock(state.mutex);
+                _ghost_write(begin, size, origin);
+            }
+            state.head.store(begin + size);
+            this->_record_commit(begin + size);
+            state::RingCounters::add(state.counters.bytes_committed, size);
+            bool notify = this->_notify_due(begin + size);
+            if( state.shm ) {
+                state.shm->head.store(begin + size);
+                if( notify ) {
+                    shm::notify(state.shm->read_event, state.shm->nread_waiting);
+                }
+            }
+            if( notify ) {
+                this->_notify_readers();
+            }
+            return;
+        }
+        state::unique_lock_type lock(state.mutex);
+        if( this->_old_write_span(origin) ) {
+            this->_copy_span_from_old_buffer(origin, begin, size);
+        }
+        _ghost_write(begin, size, origin);
+        // Note: Same ordering as commit_span, earlier spans have to be committed first
+        if( begin != state.head ) {
+            auto wait_begin = std::chrono::steady_clock::now();
+            state.write_close_condition.wait(lock, [&]() {
+                return (begin == get_state().head);
+            });
+            if( auto* histograms = state.histograms.load(std::memory_order_acquire) ) {
+                histograms->commit_wait.record(std::chrono::steady_clock::now() - wait_begin);
+            }
+        }
+        state.head += size;
+        this->_record_commit(state.head);
+        state::RingCounters::add(state.counters.bytes_committed, size);
+        bool notify = this->_notify_due(state.head);
+        if( state.shm ) {
+            state.shm->head.store(state.head);
+            if( notify ) {
+                shm::notify(state.shm->read_event, state.shm->nread_waiting);
+            }
+        }
+        if( notify ) {
+            state.read_waiters.notify_until(state.head);
+        }
+    }
+
+    void Ring::_close_span(std::atomic<std::size_t>& nopen) {
+        auto& state = get_state();
+        --nopen;
+        this->_notify_waiters(state.realloc_condition, state.nrealloc_pending);
+    }
+
+    void Ring::_notify_waiters(state::condition_type& condition, const std::atomic<std::size_t>& nwaiting) {
+        auto& state = get_state();
+        // Note: Waiters register before evaluating their predicate under the mutex, so
+        //         taking the mutex here guarantees the notification is not lost.
+        if( nwaiting.load() != 0 ) {
+            state::lock_guard_type lock(state.mutex);
+            condition.notify_all();
+        }
+    }
+
+    void Ring::_notify_readers() {
+        auto& state = get_state();
+        // Note: Same protocol as _notify_waiters, but only readers whose span is complete are woken
+        if( state.nread_waiting.load() != 0 ) {
+            state::lock_guard_type lock(state.mutex);
+            state.read_waiters.notify_until(state.head);
+        }
+    }
+
+    bool Ring::_notify_due(std::size_t head) {
+        auto& state = get_state();
+        std::int64_t interval = state.notify_interval_ns.load(std::memory_order_relaxed);
+        if( interval == 0 ) {
+            return true;
+        }
+        std::size_t  bytes = state.notify_bytes.load(std::memory_order_relaxed);
+        std::int64_t now   = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        bool due = (bytes != 0 && delta_type(head - state.notified_head.load(std::memory_order_relaxed)) >= delta_type(bytes)) ||
+                   (now - state.notified_time_ns.load(std::memory_order_relaxed) >= interval);
+        if( due ) {
+            state.notified_head.store(head, std::memory_order_relaxed);
+            state.notified_time_ns.store(now, std::memory_order_relaxed);
+        }
+        return due;
+    }
+
+    bool Ring::_sequence_discard_pending(std::size_t new_tail) const {
+        const auto& state = get_state();
+        // Note: Only the writer modifies the sequence queue, so in spsc mode the
+        //         writer thread may inspect it without the mutex.
+        return (!state.sequence_queue.empty() &&
+                state.sequence_queue.front()->is_finished() &&
+                std::size_t(state.head - state.sequence_queue.front()->m_end) >= std::size_t(state.head - new_tail));
+    }
+
+    bool Ring::_reserve_span_spsc(std::size_t size, std::size_t* begin, void** data) {
+        auto& state = get_state();
+        // Register the span first so that a concurrent resize waits for it
+        ++state.nwrite_open;
+        bool reserved = false;
+        if( !state.nrealloc_pending && size <= state.ghost_span ) {
+            std::size_t cur_begin        = state.reserve_head.load(std::memory_order_relaxed);
+            std::size_t new_reserve_head = cur_begin + size;
+            // Note: reserve_head is published before the guarantees are checked, while a new
+            //         guarantee is published before reserve_head is checked (see _clamp_guarantee),
+            //         so at least one side sees the other.
+            state.reserve_head.store(new_reserve_head);
+            if( state.shm ) {
+                state.shm->reserve_head.store(new_reserve_head);
+            }
+            if( this->_guarantees_allow(new_reserve_head) ) {
+                std::size_t new_tail = state.tail.load(std::memory_order_relaxed);
+                std::size_t cur_span = new_reserve_head - new_tail;
+                if( cur_span > state.span ) {
+                    new_tail += cur_span - state.span;
+                }
+                // Discarding old sequences is left to the locked path
+                if( !this->_sequence_discard_pending(new_tail) ) {
+                    if( new_tail != state.tail.load(std::memory_order_relaxed) ) {
+                        RB_PROBE3(tail_pull, state.name.c_str(), state.tail.load(std::memory_order_relaxed), new_tail);
+                    }
+                    state.tail.store(new_tail);
+                    if( state.shm ) {
+                        state.shm->tail.store(new_tail);
+                    }
+                    *begin = cur_begin;
+                    reserved = true;
+                }
+            }
+            if( !reserved ) {
+                state.reserve_head.store(cur_begin);
+                if( state.shm ) {
+                    state.shm->reserve_head.store(cur_begin);
+                }
+            }
+        }
+        if( !reserved ) {
+            this->_close_span(state.nwrite_open);
+            return false;
+        }
+        *data = _buf_pointer(*begin);
+        return true;
+    }
+
+    bool Ring::_commit_span_spsc(std::size_t origin, std::size_t begin, std::size_t reserve_size, std::size_t commit_size) {
+        auto& state = get_state();
+        std::size_t head         = state.head.load(std::memory_order_relaxed);
+        std::size_t reserve_head = state.reserve_head.load(std::memory_order_relaxed);
+        bool cancel = (commit_size == 0 && reserve_head == begin + reserve_size);
+        if( !cancel ) {
+            // Out-of-order commits have to wait and invalid partial commits raise in the locked path
+            if( begin != head ) {
+                return false;
+            }
+            if( reserve_head != head + reserve_size && commit_size < reserve_size ) {
+                return false;
+            }
+        }
+        if( this->_ghost_write_pending(begin, commit_size, origin) ) {
+            state::lock_guard_type lock(state.mutex);
+            _ghost_write(begin, commit_size, origin);
+        }
+        if( cancel ) {
+            state.reserve_head.store(begin);
+        }
+        else {
+            if( reserve_head == head + reserve_size ) {
+                state.reserve_head.store(head + commit_size);
+            }
+            state.head.store(head + commit_size);
+            if( commit_size ) {
+                this->_record_commit(head + commit_size);
+            }
+            state::RingCounters::add(state.counters.bytes_committed, commit_size);
+            state::RingCounters::add(state.counters.spans_committed, 1);
+        }
+        bool notify = !cancel && commit_size && this->_notify_due(head + commit_size);
+        if( state.shm ) {
+            state.shm->reserve_head.store(state.reserve_head.load());
+            state.shm->head.store(state.head.load());
+            if( notify ) {
+                shm::notify(state.shm->read_event, state.shm->nread_waiting);
+            }
+        }
+        this->_close_span(state.nwrite_open);
+        if( notify ) {
+            this->_notify_readers();
+        }
+        return true;
+    }
+
+    bool Ring::_acquire_span_spsc(ReadSequence* rsequence,
+                                  std::size_t   offset,
+                                  std::size_t*  size_,
+                                  std::size_t*  begin_,
+                                  void**        data_) {
+        auto& state = get_state();
+        SequencePtr sequence = rsequence->sequence();
+        ++state.nread_open;
+        bool available = false;
+        std::size_t begin = 0;
+        std::size_t size  = 0;
+        if( !state.nrealloc_pending && *size_ <= state.ghost_span ) {
+            std::size_t requested_begin = sequence->begin() + offset;
+            std::size_t requested_end   = requested_begin + *size_;
+            std::size_t sequence_end    = sequence->m_end;
+            bool        finished        = (sequence_end != std::size_t(Sequence::RF_SEQUENCE_OPEN));
+            // Anything that needs to wait or raise is left to the locked path
+            available = (requested_begin >= state.tail &&
+                         (finished || delta_type(state.head - requested_end) >= 0));
+            if( available && rsequence->guarantee() ) {
+                std::size_t guarantee_begin = rsequence->guarantee()->offset();
+                if( delta_type(requested_begin - guarantee_begin) > 0 ) {
+                    rsequence->guarantee()->move_nolock(requested_begin);
+                    this->_notify_waiters(state.write_condition, state.nwrite_waiting);
+                }
+            }
+            if( available ) {
+                begin = std::max(requested_begin, state.tail.load());
+                size  = std::max(delta_type(requested_end - begin), delta_type(0));
+                if( finished ) {
+                    available = (begin < sequence_end);
+                    size = std::min(size, std::size_t(sequence_end - begin));
+                }
+            }
+        }
+        if( !available ) {
+            this->_close_span(state.nread_open);
+            return false;
+        }
+        *begin_ = begin;
+        *size_  = size;
+        state::RingCounters::add(state.counters.bytes_overwritten, begin - (sequence->begin() + offset));
+        state::RingCounters::add(state.counters.bytes_acquired, size);
+        state::RingCounters::add(state.counters.spans_acquired, 1);
+        if( size ) {
+            this->_record_acquire(begin + size);
+        }
+        if( this->_ghost_read_pending(begin, size) ) {
+            state::lock_guard_type lock(state.mutex);
+            _ghost_read(begin, size);
+        }
+        *data_ = _buf_pointer(begin);
+        return true;
+    }
+
+    std::size_t Ring::current_tail_offset() const {
+        const auto& state = get_state();
+        return state.shm ? state.shm->tail.load() : state.tail.load();
+    }
+
+    RingStats Ring::stats() const {
+        using state::RingCounters;
+        const auto& state = get_state();
+        const auto& counters = state.counters;
+        RingStats stats;
+        stats.bytes_committed     = RingCounters::get(counters.bytes_committed);
+        stats.spans_committed     = RingCounters::get(counters.spans_committed);
+        stats.bytes_acquired      = RingCounters::get(counters.bytes_acquired);
+        stats.spans_acquired      = RingCounters::get(counters.spans_acquired);
+        stats.bytes_overwritten   = RingCounters::get(counters.bytes_overwritten);
+        stats.ghost_bytes_written = RingCounters::get(counters.ghost_bytes_written);
+        stats.ghost_bytes_read    = RingCounters::get(counters.ghost_bytes_read);
+        stats.write_waits         = RingCounters::get(counters.write_waits);
+        stats.write_wait_time     = std::chrono::nanoseconds(RingCounters::get(counters.write_wait_ns));
+        stats.read_waits          = RingCounters::get(counters.read_waits);
+        stats.read_wait_time      = std::chrono::nanoseconds(RingCounters::get(counters.read_wait_ns));
+        stats.reallocs            = RingCounters::get(counters.reallocs);
+
+        // Note: For shared memory rings the segment has the authoritative cursors. span and shm
+        //         change under the mutex, their published copies are read instead.
+        const shm::RingHeader* shm = state.stats_shm.load();
+        stats.span         = state.stats_span.load();
+        stats.tail         = shm ? shm->tail.load()         : state.tail.load();
+        stats.head         = shm ? shm->head.load()         : state.head.load();
+        stats.reserve_head = shm ? shm->reserve_head.load() : state.reserve_head.load();
+        stats.fill         = std::size_t(std::max(delta_type(stats.head - stats.tail), delta_type(0)));
+        const state::GuaranteeTable& guarantees = shm ? shm->guarantees : state.guarantees;
+        for( const auto& slot : guarantees.slots ) {
+            if( slot.active.load() ) {
+                stats.guarantee_lag.push_back(
+                        std::size_t(std::max(delta_type(stats.head - slot.offset.load()), delta_type(0))));
+            }
+        }
+        return stats;
+    }
+
+    void Ring::set_latency_histograms(bool enabled) {
+        auto& state = get_state();
+        state::lock_guard_type lock(state.mutex);
+        if( enabled && !state.histograms_storage ) {
+            state.histograms_storage.reset(new state::RingHistograms());
+        }
+        // Note: The storage is never freed while the ring exists, so threads that
+        //         still hold the pointer after disabling remain safe
+        state.histograms.store(enabled ? state.histograms_storage.get() : nullptr, std::memory_order_release);
+    }
+
+    RingLatencies Ring::latencies() const {
+        const auto& state = get_state();
+        RingLatencies latencies;
+        // Note: histograms_storage is only set once (under the mutex) and never reset
+        state::lock_guard_type lock(state.mutex);
+        if( const auto* histograms = state.histograms_storage.get() ) {
+            latencies.reserve_wait      = histograms->reserve_wait.summary();
+            latencies.commit_wait       = histograms->commit_wait.summary();
+            latencies.acquire_wait      = histograms->acquire_wait.summary();
+            latencies.commit_to_acquire = histograms->commit_to_acquire.summary();
+        }
+        return latencies;
+    }
+
+    void Ring::_record_commit(std::size_t head) {
+        auto& state = get_state();
+        if( auto* histograms = state.histograms.load(std::memory_order_acquire) ) {
+            histograms->commit_times.record(head, std::chrono::steady_clock::now());
+        }
+    }
+
+    void Ring::_record_acquire(std::size_t end) {
+        auto& state = get_state();
+        if( auto* histograms = state.histograms.load(std::memory_order_acquire) ) {
+            std::chrono::steady_clock::time_point committed;
+            if( histograms->commit_times.lookup(end, &committed) ) {
+                histograms->commit_to_acquire.record(std::chrono::steady_clock::now() - committed);
+            }
+        }
+    }
+
+    void Ring::_open_proclog(const std::string& filename) {
+        auto& state = get_state();
+        state.proclog.reset();
+        state.proclog.reset(new proclog::ProcLog("rings", filename, [this]() {
+            return this->_proclog_contents();
+        }));
+        this->_update_proclog_static();
+        state.proclog->update();
+    }
+
+    void Ring::_update_proclog_static() {
+        auto& state = get_state();
+        if( !state.proclog ) {
+            return;
+        }
+        std::ostringstream out;
+        out << "name : "       << state.name                  << "\n"
+            << "space : "      << getSpaceString(state.space) << "\n"
+            << "span : "       << state.span                  << "\n"
+            << "ghost_span : " << state.ghost_span            << "\n"
+            << "stride : "     << state.stride                << "\n"
+            << "nringlet : "   << state.nringlet              << "\n"
+            << "mirrored : "   << int(state.mirrored)         << "\n"
+            << "hugepages : "  << getHugePagesString(state.buf_hugepages) << "\n"
+            << "memlocked : "  << int(state.buf_memlocked)    << "\n"
+            << "numa_policy : " << getNumaPolicyString(state.numa_policy) << "\n"
+            << "numa_nodes :";
+        for( int node : state.buf_numa_nodes ) {
+            out << " " << node;
+        }
+        out << "\n"
+            << "spsc : "       << int(state.spsc)             << "\n"
+            << "shm_attached : " << int(state.shm_attached)   << "\n";
+        state.proclog->set_static(out.str());
+    }
+
+    std::string Ring::_proclog_contents() const {
+        // Note: Called from the ProcLog monitor thread, only atomics are read (no mutex)
+        const auto& state = get_state();
+        RingStats stats = this->stats();
+        std::ostringstream out;
+        out << "tail : "         << stats.tail              << "\n"
+            << "head : "         << stats.head              << "\n"
+            << "reserve_head : " << stats.reserve_head      << "\n"
+            << "fill : "         << stats.fill              << "\n"
+            << "nread_open : "   << state.nread_open.load() << "\n"
+            << "nwrite_open : "  << state.nwrite_open.load() << "\n"
+            << "guarantee_lag :";
+        for( auto lag : stats.guarantee_lag ) {
+            out << " " << lag;
+        }
+        out << "\n"
+            << "bytes_committed : "     << stats.bytes_committed     << "\n"
+            << "spans_committed : "     << stats.spans_committed     << "\n"
+            << "bytes_acquired : "      << stats.bytes_acquired      << "\n"
+            << "spans_acquired : "      << stats.spans_acquired      << "\n"
+            << "bytes_overwritten : "   << stats.bytes_overwritten   << "\n"
+            << "ghost_bytes_written : " << stats.ghost_bytes_written << "\n"
+            << "ghost_bytes_read : "    << stats.ghost_bytes_read    << "\n"
+            << "write_waits : "         << stats.write_waits         << "\n"
+            << "write_wait_ns : "       << stats.write_wait_time.count() << "\n"
+            << "read_waits : "          << stats.read_waits          << "\n"
+            << "read_wait_ns : "        << stats.read_wait_time.count() << "\n"
+            << "reallocs : "            << stats.reallocs            << "\n";
+        return out.str();
+    }
+
+    std::shared_ptr<Ring> Ring::attach(std::string name) {
+        std::shared_ptr<Ring> ring(new Ring(std::move(name), RBSpace::SPACE_SHM));
+        auto& state = ring->get_state();
+        state::lock_guard_type lock(state.mutex);
+        ring->_shm_attach();
+        // Note: The creating process may live in this process too, so attached rings get their own entry
+        if( state.proclog ) {
+            ring->_open_proclog(state.name + ".attached");
+        }
+        return ring;
+    }
+
+    void Ring::_shm_attach() {
+        auto& state = get_state();
+        RB_ASSERT_EXCEPTION(shm::attach(state.name, &state.shm_segment) == RBStatus::STATUS_SUCCESS,
+                            RBStatus::STATUS_RING_NOT_AVAILABLE);
+        state.shm          = state.shm_segment.header;
+        state.shm_attached = true;
+        state.buf          = state.shm_segment.data;
+        state.ghost_span   = state.shm->ghost_span;
+        state.span         = state.shm->span;
+        state.stats_span   = state.span;
+        state.stats_shm    = state.shm;
+        state.stride       = state.shm->stride;
+        state.nringlet     = state.shm->nringlet;
+        state.offset0      = 0;
+        state.ghost_dirty_beg = state.ghost_span;
+        // Older descriptors have been reused already
+        std::uint64_t nsequence = state.shm->nsequence.load();
+        state.shm_nsequence = (nsequence > RINGBUFFER_SHM_MAX_SEQUENCES ?
+                               nsequence - RINGBUFFER_SHM_MAX_SEQUENCES : 0);
+        this->_shm_sync();
+    }
+
+    void Ring::_shm_sync() {
+        auto& state = get_state();
+        auto* shm = state.shm;
+        // Note: The writer publishes sequences before it ends writing and commits data
+        //         before it finishes a sequence, so the order of the loads below matters.
+        bool writing_ended = shm->writing_ended.load() != 0;
+        std::uint64_t nsequence = shm->nsequence.load();
+        for( ; state.shm_nsequence < nsequence; ++state.shm_nsequence ) {
+            std::uint64_t index = state.shm_nsequence;
+            auto& desc = shm->sequences[index % RINGBUFFER_SHM_MAX_SEQUENCES];
+            if( desc.id.load() != index + 1 ) {
+                // Overwritten by a later sequence already
+                continue;
+            }
+            std::string name(desc.name, ::strnlen(desc.name, RINGBUFFER_SHM_MAX_NAME));
+            header_type header(desc.header, desc.header + std::min(desc.header_size, std::size_t(RINGBUFFER_SHM_MAX_HEADER)));
+            time_tag_type time_tag = desc.time_tag;
+            std::size_t   nringlet = desc.nringlet;
+            std::size_t   begin    = desc.begin;
+            if( desc.id.load() != index + 1 ) {
+                continue;
+            }
+            SequencePtr sequence(new Sequence(shared_from_this(), name, time_tag, header.size(),
+                                              header.data(), nringlet, begin));
+            sequence->m_shm_index = index;
+            if( !state.sequence_queue.empty() ) {
+                // The writer finished the previous sequence before it began this one
+                this->_shm_refresh_sequence(state.sequence_queue.back());
+                state.sequence_queue.back()->set_next(sequence);
+            }
+            state.sequence_queue.push(sequence);
+            if( !name.empty() ) {
+                state.sequence_map[name] = sequence;
+            }
+            if( time_tag != std::size_t(-1) ) {
+                state.sequence_time_tag_map[time_tag] = sequence;
+            }
+        }
+        if( !state.sequence_queue.empty() && !state.sequence_queue.back()->is_finished() ) {
+            this->_shm_refresh_sequence(state.sequence_queue.back());
+        }
+        state.head          = shm->head.load();
+        state.tail          = shm->tail.load();
+        state.reserve_head  = shm->reserve_head.load();
+        state.writing_begun = shm->writing_begun.load() != 0;
+        state.writing_ended = writing_ended;
+        state.eod           = shm->eod.load();
+        this->_discard_old_sequences();
+    }
+
+    void Ring::_shm_refresh_sequence(const SequencePtr& sequence) {
+        auto& state = get_state();
+        if( sequence->is_finished() ) {
+            return;
+        }
+        auto& desc = state.shm->sequences[sequence->m_shm_index % RINGBUFFER_SHM_MAX_SEQUENCES];
+        if( desc.id.load() != sequence->m_shm_index + 1 ) {
+            // The descriptor was reused, so the sequence ended and has been overwritten
+            sequence->m_end = sequence->m_begin;
+            return;
+        }
+        std::size_t end = desc.end.load();
+        if( end == std::size_t(Sequence::RF_SEQUENCE_OPEN) ) {
+            return;
+        }
+        footer_type footer(desc.footer, desc.footer + std::min(desc.footer_size, std::size_t(RINGBUFFER_SHM_MAX_HEADER)));
+        if( desc.id.load() != sequence->m_shm_index + 1 ) {
+            return;
+        }
+        sequence->m_footer = std::move(footer);
+        sequence->m_end    = end;
+    }
+
+    void Ring::_shm_publish_sequence(const SequencePtr& sequence) {
+        auto& state = get_state();
+        auto* shm = state.shm;
+        RB_ASSERT_EXCEPTION(sequence->m_name.size() < RINGBUFFER_SHM_MAX_NAME,     RBStatus::STATUS_INSUFFICIENT_STORAGE);
+        RB_ASSERT_EXCEPTION(sequence->m_header.size() <= RINGBUFFER_SHM_MAX_HEADER, RBStatus::STATUS_INSUFFICIENT_STORAGE);
+        std::uint64_t index = shm->nsequence.load();
+        // The descriptor of the oldest sequence that is still in the ring must not be reused
+        RB_ASSERT_EXCEPTION(state.sequence_queue.empty() ||
+                            index - state.sequence_queue.front()->m_shm_index < RINGBUFFER_SHM_MAX_SEQUENCES,
+                            RBStatus::STATUS_INSUFFICIENT_STORAGE);
+        auto& desc = shm->sequences[index % RINGBUFFER_SHM_MAX_SEQUENCES];
+        desc.id.store(0);
+        desc.end.store(sequence->m_end.load());
+        desc.time_tag    = sequence->m_time_tag;
+        desc.nringlet    = sequence->m_nringlet;
+        desc.begin       = sequence->m_begin;
+        desc.header_size = sequence->m_header.size();
+        desc.footer_size = 0;
+        ::memcpy(desc.name, sequence->m_name.c_str(), sequence->m_name.size() + 1);
+        if( !sequence->m_header.empty() ) {
+            ::memcpy(desc.header, sequence->m_header.data(), sequence->m_header.size());
+        }
+        desc.id.store(index + 1);
+        sequence->m_shm_index = index;
+        shm->nsequence.store(index + 1);
+        shm::notify(shm->read_event, shm->nread_waiting);
+    }
+
+    void Ring::_shm_finish_sequence(const SequencePtr& sequence) {
+        auto& state = get_state();
+        auto* shm = state.shm;
+        auto& desc = shm->sequences[sequence->m_shm_index % RINGBUFFER_SHM_MAX_SEQUENCES];
+        if( desc.id.load() == sequence->m_shm_index + 1 ) {
+            desc.footer_size = sequence->m_footer.size();
+            if( !sequence->m_footer.empty() ) {
+                ::memcpy(desc.footer, sequence->m_footer.data(), sequence->m_footer.size());
+            }
+            // Note: This marks the sequence as finished for other processes
+            desc.end.store(sequence->m_end.load());
+        }
+        shm::notify(shm->read_event, shm->nread_waiting);
+    }
 
 	int Ring::subscribe_sequence_event(void(*callback)(time_tag_type, void*), void* const userData) {
 		return m_sequence_event.connect([callback, userData](time_tag_type ts) {
@@ -59,12 +59,32 @@ namespace ringbuffer {
               m_end(RF_SEQUENCE_OPEN),
               m_header((const char*)header,
                       (const char*)header+header_size),
-              m_next(nullptr), m_readrefcount(0) {
+              m_next(nullptr), m_readrefcount(0), m_shm_index(0) {
     }
 
 	Sequence::~Sequence() = default;
-	Sequence::Sequence(Sequence&&) = default;
-	Sequence& Sequence::operator=(Sequence&&) = default;
+
+	Sequence::Sequence(Sequence&& other)
+	        : m_ring(std::move(other.m_ring)), m_name(std::move(other.m_name)), m_time_tag(other.m_time_tag),
+	          m_nringlet(other.m_nringlet), m_begin(other.m_begin), m_end(other.m_end.load()),
+	          m_header(std::move(other.m_header)), m_footer(std::move(other.m_footer)),
+	          m_next(std::move(other.m_next)), m_readrefcount(other.m_readrefcount),
+	          m_shm_index(other.m_shm_index) {}
+
+	Sequence& Sequence::operator=(Sequence&& other) {
+	    m_ring         = std::move(other.m_ring);
+	    m_name         = std::move(other.m_name);
+	    m_time_tag     = other.m_time_tag;
+	    m_nringlet     = other.m_nringlet;
+	    m_begin        = other.m_begin;
+	    m_end          = other.m_end.load();
+	    m_header       = std::move(other.m_header);
+	    m_footer       = std::move(other.m_footer);
+	    m_next         = std::move(other.m_next);
+	    m_readrefcount = other.m_readrefcount;
+	    m_shm_index    = other.m_shm_index;
+	    return *this;
+	}
 
     void Sequence::set_next(SequencePtr next) {
         m_next = std::move(next);
@@ -131,6 +151,13 @@ namespace ringbuffer {
         }
     }
 
+    RBStatus ReadSequence::try_increment_to_next(bool nonblocking, std::chrono::nanoseconds timeout) {
+        if(auto r = m_sequence->ring().lock()){
+            return r->try_increment_sequence_to_next(m_sequence, m_guarantee, nonblocking, timeout);
+        }
+        return RBStatus::STATUS_RING_NOT_AVAILABLE;
+    }
+
 
     WriteSequence::WriteSequence(const std::weak_ptr<Ring>& ring,
                                  const std::string& name,
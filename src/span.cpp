@@ -45,6 +45,8 @@
 #include "ringbuffer/ring.h"
 #include "ringbuffer/sequence.h"
 
+#include <cstring>
+
 namespace ringbuffer {
 
     void Span::set_base_size(std::size_t size) { m_size = size; }
@@ -54,20 +56,36 @@ namespace ringbuffer {
 
     std::weak_ptr<Ring> Span::ring() const { return m_ring; }
     std::size_t Span::size()     const { return m_size; }
-    std::size_t Span::stride()   const { if(auto r = m_ring.lock()){return r->current_stride();} else{return 0;} }
+    std::size_t Span::stride()   const { if(auto r = m_ring.lock()){return r->span_stride(this->data());} else{return 0;} }
     std::size_t Span::nringlet() const { if(auto r = m_ring.lock()){return r->current_nringlet();} else{return 0;} }
 
 
     WriteSpan::WriteSpan(const std::weak_ptr<Ring>& ring, std::size_t size, bool nonblocking, std::chrono::nanoseconds timeout)
-            : Span(ring, size), m_begin(0), m_commit_size(size), m_data(nullptr) {
+            : Span(ring, size), m_begin(0), m_commit_size(size), m_data(nullptr), m_valid(false) {
         if(auto r = this->ring().lock()){
             r->reserve_span(size, &m_begin, &m_data, nonblocking, timeout);
+            m_valid = true;
         }
         else{
            throw new RBException(RBStatus::STATUS_RING_NOT_AVAILABLE);
         }
     }
 
+    WriteSpan::WriteSpan(const std::weak_ptr<Ring>& ring, std::size_t size, bool nonblocking, RBStatus* status, std::chrono::nanoseconds timeout)
+            : Span(ring, size), m_begin(0), m_commit_size(size), m_data(nullptr), m_valid(false) {
+        if(auto r = this->ring().lock()){
+            *status = r->try_reserve_span(size, &m_begin, &m_data, nonblocking, timeout);
+            m_valid = (*status == RBStatus::STATUS_SUCCESS);
+        }
+        else{
+            *status = RBStatus::STATUS_RING_NOT_AVAILABLE;
+        }
+        if( !m_valid ) {
+            this->set_base_size(0);
+            m_commit_size = 0;
+        }
+    }
+
     WriteSpan* WriteSpan::commit(std::size_t size) {
         RB_ASSERT_EXCEPTION(size <= this->size(), RBStatus::STATUS_INVALID_ARGUMENT);
         m_commit_size = size;
@@ -75,6 +93,9 @@ namespace ringbuffer {
     }
 
     WriteSpan::~WriteSpan() {
+        if( !m_valid ) {
+            return;
+        }
         if(auto r = this->ring().lock()){
             r->commit_span(m_begin, this->size(), m_commit_size);
         }
@@ -84,26 +105,120 @@ namespace ringbuffer {
     std::size_t WriteSpan::offset()   const { return m_begin; }
 
 
+    WriteBatch::WriteBatch(const std::weak_ptr<Ring>& ring, std::size_t capacity, bool nonblocking,
+                           std::chrono::nanoseconds timeout)
+            : m_ring(ring), m_capacity(capacity), m_nonblocking(nonblocking), m_timeout(timeout),
+              m_begin(0), m_reserved(0), m_published(0), m_used(0), m_data(nullptr), m_open(false) {
+        RB_ASSERT_EXCEPTION(capacity > 0, RBStatus::STATUS_INVALID_ARGUMENT);
+        this->_reserve();
+    }
+
+    WriteBatch::~WriteBatch() {
+        if( m_open ) {
+            if(auto r = m_ring.lock()){
+                r->_commit_span(m_begin, m_begin + m_published, m_reserved - m_published, m_used - m_published);
+            }
+        }
+    }
+
+    void WriteBatch::_reserve() {
+        if(auto r = m_ring.lock()){
+            void* data = nullptr;
+            r->reserve_span(m_capacity, &m_begin, &data, m_nonblocking, m_timeout);
+            m_data      = static_cast<uint8_t*>(data);
+            m_reserved  = m_capacity;
+            m_published = 0;
+            m_used      = 0;
+            m_open      = true;
+        } else {
+            throw RBException(RBStatus::STATUS_RING_NOT_AVAILABLE);
+        }
+    }
+
+    void* WriteBatch::allocate(std::size_t size) {
+        RB_ASSERT_EXCEPTION(size <= m_capacity, RBStatus::STATUS_INVALID_ARGUMENT);
+        if( !m_open || m_used + size > m_reserved ) {
+            this->commit();
+            this->_reserve();
+        }
+        void* record = m_data + m_used;
+        m_used += size;
+        return record;
+    }
+
+    void WriteBatch::append(const void* data, std::size_t size) {
+        ::memcpy(this->allocate(size), data, size);
+    }
+
+    std::size_t WriteBatch::flush() {
+        std::size_t size = m_used - m_published;
+        if( m_open && size > 0 ) {
+            if(auto r = m_ring.lock()){
+                r->_publish_span(m_begin, m_begin + m_published, size);
+                m_published = m_used;
+            } else {
+                throw RBException(RBStatus::STATUS_RING_NOT_AVAILABLE);
+            }
+        }
+        return size;
+    }
+
+    void WriteBatch::commit() {
+        if( !m_open ) {
+            return;
+        }
+        // Note: Marked closed first, the destructor must not commit twice if this throws
+        m_open = false;
+        if(auto r = m_ring.lock()){
+            r->_commit_span(m_begin, m_begin + m_published, m_reserved - m_published, m_used - m_published);
+        } else {
+            throw RBException(RBStatus::STATUS_RING_NOT_AVAILABLE);
+        }
+    }
+
+
     ReadSpan::ReadSpan(ReadSequence*   sequence,
                        std::size_t    offset, // Relative to sequence beg
                        std::size_t    requested_size,
                        std::chrono::nanoseconds timeout)
             : Span(sequence->ring(), requested_size),
-              m_sequence(sequence), m_begin(0), m_data(nullptr) {
+              m_sequence(sequence), m_begin(0), m_data(nullptr), m_valid(false) {
         std::size_t returned_size = requested_size;
         // @todo: this call potentially blocks until data can read
         if(auto r = this->ring().lock()){
             r->acquire_span(sequence, offset, &returned_size, &m_begin, &m_data, timeout);
             this->set_base_size(returned_size);
+            m_valid = true;
         } else {
             throw new RBException(RBStatus::STATUS_RING_NOT_AVAILABLE);
         }
         
     }
 
+    ReadSpan::ReadSpan(ReadSequence*   sequence,
+                       std::size_t    offset, // Relative to sequence beg
+                       std::size_t    requested_size,
+                       bool           nonblocking,
+                       RBStatus*      status,
+                       std::chrono::nanoseconds timeout)
+            : Span(sequence->ring(), requested_size),
+              m_sequence(sequence), m_begin(0), m_data(nullptr), m_valid(false) {
+        std::size_t returned_size = requested_size;
+        if(auto r = this->ring().lock()){
+            *status = r->try_acquire_span(sequence, offset, &returned_size, &m_begin, &m_data, nonblocking, timeout);
+            m_valid = (*status == RBStatus::STATUS_SUCCESS);
+        } else {
+            *status = RBStatus::STATUS_RING_NOT_AVAILABLE;
+        }
+        this->set_base_size(m_valid ? returned_size : 0);
+    }
+
     ReadSpan::~ReadSpan() {
+        if( !m_valid ) {
+            return;
+        }
         if(auto r = this->ring().lock()){
-            r->release_span(m_sequence, m_begin, this->size());
+            r->release_span(m_sequence, m_begin, this->size(), m_data);
         }
     }
 
@@ -0,0 +1,100 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include "ringbuffer/ring.h"
+#include "ringbuffer/detail/affinity.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace ringbuffer;
+
+#if defined __linux__ && __linux__
+TEST(RingbufferTestSuite, AffinityTopology) {
+    std::vector<int> original;
+    ASSERT_EQ(affinity::affinityGetCores(&original), RBStatus::STATUS_SUCCESS);
+    ASSERT_FALSE(original.empty());
+    int core = original.front();
+
+    // every core shares its L1 at least with itself
+    std::vector<int> l1;
+    ASSERT_EQ(affinity::topologyGetCacheCores(core, 1, &l1), RBStatus::STATUS_SUCCESS);
+    EXPECT_NE(std::find(l1.begin(), l1.end(), core), l1.end());
+
+    std::vector<std::vector<int>> domains;
+    ASSERT_EQ(affinity::topologyGetCacheDomains(1, &domains), RBStatus::STATUS_SUCCESS);
+    EXPECT_NE(std::find(domains.begin(), domains.end(), l1), domains.end());
+
+    std::vector<int> placed;
+    ASSERT_EQ(affinity::topologyPlaceOnCache(core, 1, 3, &placed), RBStatus::STATUS_SUCCESS);
+    ASSERT_EQ(placed.size(), 3);
+    EXPECT_EQ(placed.front(), core);
+    for (int c : placed) {
+        EXPECT_NE(std::find(l1.begin(), l1.end(), c), l1.end());
+    }
+    EXPECT_NE(affinity::topologyGetCacheCores(core, 9, &placed), RBStatus::STATUS_SUCCESS);
+
+    std::thread thread([&]() {
+        std::vector<int> cores;
+        ASSERT_EQ(affinity::affinitySetCacheDomain(core, 1), RBStatus::STATUS_SUCCESS);
+        ASSERT_EQ(affinity::affinityGetCores(&cores), RBStatus::STATUS_SUCCESS);
+        EXPECT_EQ(cores, l1);
+
+        std::vector<int> node_cores;
+        if (affinity::topologyGetNumaNodeCores(0, &node_cores) == RBStatus::STATUS_SUCCESS && !node_cores.empty()) {
+            ASSERT_EQ(affinity::affinitySetNumaNode(0), RBStatus::STATUS_SUCCESS);
+            ASSERT_EQ(affinity::affinityGetCores(&cores), RBStatus::STATUS_SUCCESS);
+            EXPECT_EQ(cores, node_cores);
+        }
+        EXPECT_EQ(affinity::affinitySetCores({}), RBStatus::STATUS_SUCCESS);
+    });
+    thread.join();
+
+    auto ring = Ring::create("testring_affinity", RBSpace::SPACE_SYSTEM);
+    EXPECT_THROW(ring->cores_sharing_cache(), std::exception);
+    ring->set_core(core);
+    EXPECT_EQ(ring->cores_sharing_cache(1), l1);
+}
+#endif
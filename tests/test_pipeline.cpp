@@ -47,6 +47,7 @@
 
 #include <thread>
 #include <chrono>
+#include <atomic>
 #include <iostream>
 
 #include "ringbuffer/ring.h"
@@ -57,6 +58,46 @@
 #include "ringbuffer/detail/affinity.h"
 #include "ringbuffer/detail/cuda.h"
 
+// One guaranteed reader thread and the writer on the calling thread. The reader asks for
+//   nrecords records of record_bytes and passes each to check(read_span, n), it stops at the
+//   first record that fails. write(received) produces the records once the reader holds its
+//   guarantee, received counts the records the reader got so far.
+// Returns the number of records the reader got.
+template<typename Check, typename Write>
+static std::size_t run_threaded(const std::shared_ptr<ringbuffer::Ring>& ring,
+                                std::size_t nrecords, std::size_t record_bytes,
+                                Check&& check, Write&& write) {
+    using namespace ringbuffer;
+
+    std::atomic<bool> reader_ready{false};
+    std::atomic<std::size_t> received{0};
+
+    auto recv_thread = std::thread([&](){
+        auto read_seq = ReadSequence::earliest_or_latest(ring, true, false);
+        reader_ready = true;
+        for (std::size_t n=0; n < nrecords; n++) {
+            ReadSpan read_span(&read_seq, n*record_bytes, record_bytes);
+            if (read_span.size() != record_bytes || !check(read_span, n)) {
+                break;
+            }
+            received++;
+        }
+    });
+
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "", 0, 0, nullptr, 1);
+        while (!reader_ready) {
+            std::this_thread::yield();
+        }
+        write(received);
+    }
+    ring->end_writing();
+
+    recv_thread.join();
+    return received;
+}
+
 TEST(RingbufferTestSuite, RingbufferThreaded){
     using namespace ringbuffer;
     using namespace std::chrono;
@@ -233,6 +274,220 @@ TEST(RingbufferTestSuite, RingbufferThreaded){
     spdlog::info("received bytes: {0}", received_bytes);
 
 }
+TEST(RingbufferTestSuite, RingbufferThreadedSPSC){
+    using namespace ringbuffer;
+
+    auto ring = Ring::create("telemetry01", RBSpace::SPACE_SYSTEM);
+    ring->set_spsc(true);
+    EXPECT_TRUE(ring->spsc());
+
+    //Set our ring variables
+    std::size_t niter = 100000;
+    std::size_t nvalues = 125;
+    std::size_t nbytes = sizeof(uint64_t)*nvalues; // does not divide the ring size, so spans wrap
+    std::size_t buffer_bytes = 16*nbytes;
+
+    ring->resize(nbytes, buffer_bytes, 1);
+
+    std::size_t received_packages = run_threaded(ring, niter, nbytes,
+        [&](ReadSpan& read_span, std::size_t n) {
+            auto* values = static_cast<uint64_t*>(read_span.data());
+            for (std::size_t j=0; j<nvalues; j++) {
+                if (values[j] != n) {
+                    return false;
+                }
+            }
+            return true;
+        },
+        [&](const std::atomic<std::size_t>&) {
+            for (std::size_t i=0; i < niter; i++) {
+                WriteSpan write_span(ring, nbytes, false);
+                auto* values = static_cast<uint64_t*>(write_span.data());
+                for (std::size_t j=0; j<nvalues; j++) {
+                    values[j] = i;
+                }
+                write_span.commit(nbytes);
+            }
+        });
+    EXPECT_EQ(received_packages, niter);
+}
+
+TEST(RingbufferTestSuite, RingbufferThreadedWaitPolicies){
+    using namespace ringbuffer;
+
+    for (auto policy : {RBWaitPolicy::WAIT_SPIN, RBWaitPolicy::WAIT_SPIN_YIELD, RBWaitPolicy::WAIT_ADAPTIVE}) {
+        auto ring = Ring::create("telemetry02", RBSpace::SPACE_SYSTEM);
+        ring->set_wait_policy(policy, 64);
+        EXPECT_EQ(ring->wait_policy(), policy);
+        EXPECT_EQ(ring->spin_count(), 64);
+
+        std::size_t niter = 500;
+        std::size_t nvalues = 64;
+        std::size_t nbytes = sizeof(uint64_t)*nvalues;
+
+        ring->resize(nbytes, 4*nbytes, 1);
+
+        std::size_t received_packages = run_threaded(ring, niter, nbytes,
+            [&](ReadSpan& read_span, std::size_t n) {
+                auto* values = static_cast<uint64_t*>(read_span.data());
+                return values[0] == n && values[nvalues-1] == n;
+            },
+            [&](const std::atomic<std::size_t>&) {
+                for (std::size_t i=0; i < niter; i++) {
+                    WriteSpan write_span(ring, nbytes, false);
+                    auto* values = static_cast<uint64_t*>(write_span.data());
+                    for (std::size_t j=0; j<nvalues; j++) {
+                        values[j] = i;
+                    }
+                    write_span.commit(nbytes);
+                }
+            });
+        EXPECT_EQ(received_packages, niter) << getWaitPolicyString(policy);
+    }
+}
+
+TEST(RingbufferTestSuite, RingbufferThreadedManyReaders){
+    using namespace ringbuffer;
+
+    auto ring = Ring::create("telemetry03", RBSpace::SPACE_SYSTEM);
+
+    // readers ask for large spans that the writer commits in small pieces
+    std::size_t nreaders = 12;
+    std::size_t niter = 200;
+    std::size_t npieces = 8;
+    std::size_t nvalues = 256;
+    std::size_t nbytes = sizeof(uint64_t)*nvalues;
+    std::size_t piece_bytes = nbytes / npieces;
+
+    ring->resize(nbytes, 8*nbytes, 1);
+    ring->begin_writing();
+
+    std::atomic<std::size_t> readers_ready{0};
+    std::vector<std::size_t> received_packages(nreaders, 0);
+    std::vector<char> data_ok(nreaders, 1);
+
+    std::vector<std::thread> recv_threads;
+    for (std::size_t r=0; r < nreaders; r++) {
+        recv_threads.emplace_back([&, r](){
+            auto read_seq = ReadSequence::earliest_or_latest(ring, true, true);
+            ++readers_ready;
+            for (std::size_t n=0; n < niter; n++) {
+                ReadSpan read_span(&read_seq, n*nbytes, nbytes);
+                auto* values = static_cast<uint64_t*>(read_span.data());
+                if (read_span.size() != nbytes || values[0] != n || values[nvalues-1] != n) {
+                    data_ok[r] = 0;
+                    break;
+                }
+                received_packages[r]++;
+            }
+        });
+    }
+
+    {
+        WriteSequence write_seq(ring, "", 0, 0, nullptr, 1);
+        while (readers_ready != nreaders) {
+            std::this_thread::yield();
+        }
+        for (std::size_t i=0; i < niter; i++) {
+            for (std::size_t p=0; p < npieces; p++) {
+                WriteSpan write_span(ring, piece_bytes, false);
+                auto* values = static_cast<uint64_t*>(write_span.data());
+                for (std::size_t j=0; j < piece_bytes/sizeof(uint64_t); j++) {
+                    values[j] = i;
+                }
+                write_span.commit(piece_bytes);
+            }
+        }
+    }
+    ring->end_writing();
+
+    for (auto& t : recv_threads) {
+        t.join();
+    }
+    for (std::size_t r=0; r < nreaders; r++) {
+        EXPECT_TRUE(data_ok[r] != 0);
+        EXPECT_EQ(received_packages[r], niter);
+    }
+}
+
+TEST(RingbufferTestSuite, RingbufferThreadedBatch){
+    using namespace ringbuffer;
+
+    struct Record {
+        uint64_t index{0};
+        uint64_t values[7]{};
+    };
+
+    for (bool spsc : {false, true}) {
+        auto ring = Ring::create("telemetry04", RBSpace::SPACE_SYSTEM);
+        ring->set_spsc(spsc);
+
+        std::size_t nrecords = 100000;
+        std::size_t batch_bytes = 100*sizeof(Record) + 16; // not a multiple of the record size
+        ring->resize(batch_bytes, 8*batch_bytes, 1);
+
+        std::size_t received_records = run_threaded(ring, nrecords, sizeof(Record),
+            [&](ReadSpan& read_span, std::size_t n) {
+                auto* record = static_cast<Record*>(read_span.data());
+                return record->index == n && record->values[6] == n;
+            },
+            [&](const std::atomic<std::size_t>&) {
+                WriteBatch batch(ring, batch_bytes);
+                for (std::size_t i=0; i < nrecords; i++) {
+                    Record record;
+                    record.index = i;
+                    record.values[6] = i;
+                    batch.append(&record, sizeof(record));
+                    if (i % 16 == 15) {
+                        // Note: Records before a rollover to a new reservation are already committed
+                        EXPECT_LE(batch.flush(), 16*sizeof(Record));
+                        EXPECT_EQ(batch.pending(), 0);
+                    }
+                }
+                batch.commit();
+                EXPECT_EQ(batch.pending(), 0);
+            });
+        EXPECT_EQ(received_records, nrecords);
+    }
+}
+
+TEST(RingbufferTestSuite, RingbufferThreadedCoalescedNotify){
+    using namespace ringbuffer;
+
+    for (bool spsc : {false, true}) {
+        auto ring = Ring::create("telemetry05", RBSpace::SPACE_SYSTEM);
+        ring->set_spsc(spsc);
+        EXPECT_THROW(ring->set_notify_coalescing(4096, std::chrono::microseconds(0)), RBException);
+        ring->set_notify_coalescing(4096, std::chrono::microseconds(500));
+        EXPECT_EQ(ring->notify_bytes(), 4096);
+        EXPECT_EQ(ring->notify_interval(), std::chrono::microseconds(500));
+
+        std::size_t niter = 20000;
+        std::size_t nbytes = sizeof(uint64_t);
+        ring->resize(64*nbytes, 1024*nbytes, 1);
+
+        // the reader asks for every record, the writer only notifies every 4096 bytes
+        std::size_t received_records = run_threaded(ring, niter+1, nbytes,
+            [&](ReadSpan& read_span, std::size_t n) {
+                return *static_cast<uint64_t*>(read_span.data()) == n;
+            },
+            [&](const std::atomic<std::size_t>& received) {
+                for (std::size_t i=0; i <= niter; i++) {
+                    WriteSpan write_span(ring, nbytes, false);
+                    *static_cast<uint64_t*>(write_span.data()) = i;
+                    write_span.commit(nbytes);
+                }
+                // the last record is below the byte threshold, the interval bounds its delivery
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                while (received < niter+1 && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                EXPECT_EQ(received, niter+1);
+            });
+        EXPECT_EQ(received_records, niter+1);
+    }
+}
+
 #ifdef RINGBUFFER_WITH_CUDA
 
 TEST(RingbufferTestSuite, RingbufferThreadedCuda){
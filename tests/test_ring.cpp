@@ -49,6 +49,19 @@
 #include "ringbuffer/sequence.h"
 #include "ringbuffer/span.h"
 #include "ringbuffer/detail/guarantee.h"
+#include "ringbuffer/detail/memory.h"
+#include "ringbuffer/detail/proclog.h"
+#include "ringbuffer/detail/trace.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined __linux__ && __linux__
+#include <sys/mman.h>
+#endif
 
 TEST(RingbufferTestSuite, RingClass) {
     using namespace ringbuffer;
@@ -260,4 +273,1146 @@ TEST(RingbufferTestSuite, RingClassMulti) {
 
 //delete the ring from memory
 
-}
\ No newline at end of file
+}
+TEST(RingbufferTestSuite, RingClassMirrored) {
+    using namespace ringbuffer;
+
+    setDebugEnabled(true);
+
+    std::string name = "testring_mirrored";
+    RBSpace space = RBSpace::SPACE_SYSTEM;
+
+    auto ring = Ring::create(name, space);
+    ring->set_mirrored(true);
+    EXPECT_TRUE(ring->mirrored());
+
+//Set our ring variables
+    std::size_t niter = 1000;
+    std::size_t nringlets = 2;
+    std::size_t nvalues = 750; // 3000 bytes per span do not divide the ring span, so spans wrap
+    std::size_t nbytes = sizeof(uint32_t) * nvalues;
+
+    ring->resize(nbytes, 2 * nbytes, nringlets);
+    EXPECT_EQ(ring->locked_stride(), 2 * ring->locked_total_span());
+    EXPECT_EQ(ring->locked_total_span() % memory::getPageSize(), 0);
+
+    // mirrored storage cannot be changed once allocated
+    EXPECT_THROW(ring->set_mirrored(false), std::exception);
+
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, nringlets, 0);
+        auto read_seq = ReadSequence::by_name(ring, "mysequence", true);
+
+        std::size_t stride = ring->locked_stride();
+        for (std::size_t i = 0; i < niter; i++) {
+            {
+                WriteSpan write_span(ring, nbytes, false);
+                for (std::size_t r = 0; r < nringlets; r++) {
+                    auto* values = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(write_span.data()) + r * stride);
+                    for (std::size_t j = 0; j < nvalues; j++) {
+                        values[j] = uint32_t(i * nvalues + j + r);
+                    }
+                }
+                write_span.commit(nbytes);
+            }
+            {
+                ReadSpan read_span(&read_seq, i * nbytes, nbytes);
+                EXPECT_EQ(read_span.size(), nbytes);
+                for (std::size_t r = 0; r < nringlets; r++) {
+                    auto* values = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(read_span.data()) + r * stride);
+                    for (std::size_t j = 0; j < nvalues; j++) {
+                        ASSERT_EQ(values[j], uint32_t(i * nvalues + j + r));
+                    }
+                }
+            }
+        }
+        write_seq.finish();
+    }
+    ring->end_writing();
+}
+
+TEST(RingbufferTestSuite, RingClassHugePages) {
+    using namespace ringbuffer;
+
+    setDebugEnabled(true);
+
+    std::size_t huge = memory::getHugePageSize(RBHugePages::HUGEPAGES_2MB);
+    {
+        void* ptr = nullptr;
+        RBHugePages used = RBHugePages::HUGEPAGES_NONE;
+        ASSERT_EQ(memory::mallocHuge(&ptr, 3 * huge / 2, RBHugePages::HUGEPAGES_2MB, &used), RBStatus::STATUS_SUCCESS);
+        EXPECT_NE(used, RBHugePages::HUGEPAGES_NONE);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % memory::getHugePageSize(used), 0);
+        std::memset(ptr, 0x5a, 3 * huge / 2);
+        EXPECT_EQ(memory::freeHuge(ptr, 3 * huge / 2, used), RBStatus::STATUS_SUCCESS);
+    }
+
+    auto ring = Ring::create("testring_hugepages", RBSpace::SPACE_SYSTEM);
+    ring->set_hugepages(RBHugePages::HUGEPAGES_2MB);
+    EXPECT_EQ(ring->hugepages(), RBHugePages::HUGEPAGES_2MB);
+    EXPECT_THROW(ring->set_mirrored(true), std::exception);
+
+    std::size_t niter = 1000;
+    std::size_t nringlets = 2;
+    std::size_t nvalues = 750;
+    std::size_t nbytes = sizeof(uint32_t) * nvalues;
+
+    ring->resize(nbytes, 256 * nbytes, nringlets);
+    std::size_t stride = ring->locked_stride();
+    EXPECT_EQ(stride % huge, 0);
+    EXPECT_GE(stride, ring->locked_total_span() + ring->locked_contiguous_span());
+    // the sandbox or kernel may not have a huge page pool, then transparent huge pages are used
+    EXPECT_TRUE(ring->hugepages_in_use() == RBHugePages::HUGEPAGES_2MB ||
+                ring->hugepages_in_use() == RBHugePages::HUGEPAGES_TRANSPARENT);
+
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, nringlets, 0);
+        auto read_seq = ReadSequence::by_name(ring, "mysequence", true);
+
+        for (std::size_t i = 0; i < niter; i++) {
+            {
+                WriteSpan write_span(ring, nbytes, false);
+                for (std::size_t r = 0; r < nringlets; r++) {
+                    auto* values = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(write_span.data()) + r * stride);
+                    for (std::size_t j = 0; j < nvalues; j++) {
+                        values[j] = uint32_t(i * nvalues + j + r);
+                    }
+                }
+                write_span.commit(nbytes);
+            }
+            {
+                ReadSpan read_span(&read_seq, i * nbytes, nbytes);
+                EXPECT_EQ(read_span.size(), nbytes);
+                for (std::size_t r = 0; r < nringlets; r++) {
+                    auto* values = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(read_span.data()) + r * stride);
+                    for (std::size_t j = 0; j < nvalues; j++) {
+                        ASSERT_EQ(values[j], uint32_t(i * nvalues + j + r));
+                    }
+                }
+            }
+        }
+        write_seq.finish();
+    }
+    ring->end_writing();
+
+    // rings smaller than a huge page keep their ghost region within the span, and grow
+    //   with the data they hold
+    auto small = Ring::create("testring_hugepages_small", RBSpace::SPACE_SYSTEM);
+    small->set_hugepages(RBHugePages::HUGEPAGES_2MB);
+    std::size_t nsmall = 4096;
+    small->resize(nsmall, 16 * nsmall, 1);
+    EXPECT_EQ(small->locked_contiguous_span(), nsmall);
+    EXPECT_EQ(small->locked_total_span(), 16 * nsmall);
+    EXPECT_EQ(small->locked_stride() % huge, 0);
+    small->begin_writing();
+    {
+        WriteSequence write_seq(small, "mysequence", 0, 0, nullptr, 1, 0);
+        auto read_seq = ReadSequence::by_name(small, "mysequence", false);
+        // wrap once, so the data spans the end of the buffer
+        std::size_t nspan = 20;
+        for (std::size_t i = 0; i < nspan; i++) {
+            WriteSpan write_span(small, nsmall, false);
+            std::memset(write_span.data(), int(i + 1), nsmall);
+            write_span.commit(nsmall);
+        }
+        small->resize(2 * nsmall, 32 * nsmall, 1);
+        EXPECT_EQ(small->locked_contiguous_span(), 2 * nsmall);
+        EXPECT_EQ(small->locked_total_span(), 32 * nsmall);
+        for (std::size_t i = nspan - 16; i < nspan; i++) {
+            ReadSpan read_span(&read_seq, i * nsmall, nsmall);
+            ASSERT_EQ(read_span.size(), nsmall);
+            const auto* values = static_cast<const uint8_t*>(read_span.data());
+            ASSERT_EQ(values[0], uint8_t(i + 1));
+            ASSERT_EQ(values[nsmall - 1], uint8_t(i + 1));
+        }
+        write_seq.finish();
+    }
+    small->end_writing();
+}
+
+TEST(RingbufferTestSuite, RingClassManyGuarantees) {
+    using namespace ringbuffer;
+
+    setDebugEnabled(true);
+
+    auto ring = Ring::create("testring_guarantees", RBSpace::SPACE_SYSTEM);
+
+    std::size_t nreaders = 12;
+    std::size_t nbytes = 1024;
+    ring->resize(nbytes, 4 * nbytes, 1);
+    std::size_t nspans = ring->locked_total_span() / nbytes;
+
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, 1, 0);
+
+        std::vector<std::unique_ptr<ReadSequence>> readers;
+        for (std::size_t r = 0; r < nreaders; r++) {
+            readers.push_back(ReadSequence::by_name_ptr(ring, "mysequence", true));
+        }
+
+        // fill the ring, the guarantees hold the first span
+        for (std::size_t i = 0; i < nspans; i++) {
+            WriteSpan write_span(ring, nbytes, true);
+            write_span.commit(nbytes);
+        }
+        EXPECT_THROW(WriteSpan(ring, nbytes, true), RBException);
+
+        // the writer can only continue once the slowest reader has moved on
+        for (std::size_t r = 0; r < nreaders; r++) {
+            { ReadSpan read_span(readers[r].get(), nbytes, nbytes); }
+            if (r + 1 < nreaders) {
+                EXPECT_THROW(WriteSpan(ring, nbytes, true), RBException);
+            }
+        }
+        {
+            WriteSpan write_span(ring, nbytes, true);
+            write_span.commit(nbytes);
+        }
+
+        // closing a reader releases its guarantee
+        for (std::size_t r = 1; r < nreaders; r++) {
+            { ReadSpan read_span(readers[r].get(), 2 * nbytes, nbytes); }
+        }
+        EXPECT_THROW(WriteSpan(ring, nbytes, true), RBException);
+        readers[0].reset();
+        {
+            WriteSpan write_span(ring, nbytes, true);
+            write_span.commit(nbytes);
+        }
+        readers.clear();
+        write_seq.finish();
+    }
+    ring->end_writing();
+}
+
+TEST(RingbufferTestSuite, RingClassTryApi) {
+    using namespace ringbuffer;
+
+    auto ring = Ring::create("testring_try", RBSpace::SPACE_SYSTEM);
+
+    std::size_t nbytes = 1024;
+    ring->resize(nbytes, 4 * nbytes, 1);
+    std::size_t nspans = ring->locked_total_span() / nbytes;
+
+    ring->begin_writing();
+    {
+        auto write_seq = std::make_unique<WriteSequence>(ring, "mysequence", 0, 0, nullptr, 1, 0);
+        auto read_seq = ReadSequence::by_name_ptr(ring, "mysequence", true);
+        RBStatus status;
+
+        // nothing written yet
+        {
+            ReadSpan read_span(read_seq.get(), 0, nbytes, true, &status);
+            EXPECT_EQ(status, RBStatus::STATUS_WOULD_BLOCK);
+            EXPECT_FALSE(read_span.valid());
+            EXPECT_EQ(read_span.size(), 0);
+        }
+        {
+            ReadSpan read_span(read_seq.get(), 0, nbytes, false, &status, std::chrono::milliseconds(1));
+            EXPECT_EQ(status, RBStatus::STATUS_WAIT_TIMEOUT);
+        }
+
+        // fill the ring, the guarantee holds the first span
+        for (std::size_t i = 0; i < nspans; i++) {
+            WriteSpan write_span(ring, nbytes, true, &status);
+            EXPECT_EQ(status, RBStatus::STATUS_SUCCESS);
+            EXPECT_TRUE(write_span.valid());
+            write_span.commit(nbytes);
+        }
+        {
+            WriteSpan write_span(ring, nbytes, true, &status);
+            EXPECT_EQ(status, RBStatus::STATUS_WOULD_BLOCK);
+            EXPECT_FALSE(write_span.valid());
+        }
+        {
+            ReadSpan read_span(read_seq.get(), 0, nbytes, true, &status);
+            EXPECT_EQ(status, RBStatus::STATUS_SUCCESS);
+            EXPECT_TRUE(read_span.valid());
+            EXPECT_EQ(read_span.size(), nbytes);
+        }
+
+        // no next sequence yet
+        EXPECT_EQ(read_seq->try_increment_to_next(), RBStatus::STATUS_WOULD_BLOCK);
+        EXPECT_EQ(read_seq->try_increment_to_next(false, std::chrono::milliseconds(1)), RBStatus::STATUS_WAIT_TIMEOUT);
+        EXPECT_EQ(read_seq->name(), "mysequence");
+
+        write_seq.reset();
+        {
+            ReadSpan read_span(read_seq.get(), nspans * nbytes, nbytes, true, &status);
+            EXPECT_EQ(status, RBStatus::STATUS_END_OF_DATA);
+        }
+        ring->end_writing();
+        EXPECT_EQ(read_seq->try_increment_to_next(), RBStatus::STATUS_END_OF_DATA);
+    }
+}
+
+TEST(RingbufferTestSuite, RingClassStats) {
+    using namespace ringbuffer;
+
+    auto ring = Ring::create("testring_stats", RBSpace::SPACE_SYSTEM);
+
+    std::size_t nbytes = 1024;
+    ring->resize(nbytes, 4 * nbytes, 1);
+    std::size_t nspans = ring->locked_total_span() / nbytes;
+    EXPECT_EQ(ring->stats().reallocs, 1);
+
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, 1, 0);
+        auto guaranteed = ReadSequence::by_name_ptr(ring, "mysequence", true);
+        auto unguaranteed = ReadSequence::by_name_ptr(ring, "mysequence", false);
+
+        for (std::size_t i = 0; i < nspans; i++) {
+            WriteSpan write_span(ring, nbytes, true);
+            write_span.commit(nbytes);
+        }
+        auto stats = ring->stats();
+        EXPECT_EQ(stats.bytes_committed, nspans * nbytes);
+        EXPECT_EQ(stats.spans_committed, nspans);
+        EXPECT_EQ(stats.fill, nspans * nbytes);
+        ASSERT_EQ(stats.guarantee_lag.size(), 1);
+        EXPECT_EQ(stats.guarantee_lag[0], nspans * nbytes);
+
+        { ReadSpan read_span(guaranteed.get(), 0, nbytes); }
+        { ReadSpan read_span(guaranteed.get(), nbytes, nbytes); }
+        stats = ring->stats();
+        EXPECT_EQ(stats.bytes_acquired, 2 * nbytes);
+        EXPECT_EQ(stats.spans_acquired, 2);
+        EXPECT_EQ(stats.guarantee_lag[0], (nspans - 1) * nbytes);
+
+        // overwrite the first span before the unguaranteed reader gets to it
+        {
+            WriteSpan write_span(ring, nbytes, true);
+            write_span.commit(nbytes);
+        }
+        EXPECT_THROW(ReadSpan(unguaranteed.get(), 0, nbytes), RBException);
+        stats = ring->stats();
+        EXPECT_EQ(stats.bytes_overwritten, nbytes);
+        EXPECT_EQ(stats.fill, nspans * nbytes);
+
+        // wait for data that is never written
+        EXPECT_THROW(ReadSpan(guaranteed.get(), (nspans + 1) * nbytes, nbytes, std::chrono::milliseconds(1)), RBException);
+        stats = ring->stats();
+        EXPECT_EQ(stats.read_waits, 1);
+        EXPECT_GE(stats.read_wait_time, std::chrono::milliseconds(1));
+        EXPECT_EQ(stats.write_waits, 0);
+    }
+    ring->end_writing();
+}
+
+TEST(RingbufferTestSuite, RingClassLatencies) {
+    using namespace ringbuffer;
+
+    auto ring = Ring::create("testring_latencies", RBSpace::SPACE_SYSTEM);
+
+    std::size_t nbytes = 1024;
+    ring->resize(nbytes, 4 * nbytes, 1);
+    EXPECT_EQ(ring->latencies().commit_to_acquire.count, 0);
+
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, 1, 0);
+        auto guaranteed = ReadSequence::by_name_ptr(ring, "mysequence", true);
+
+        // nothing is recorded until the histograms are enabled
+        {
+            WriteSpan write_span(ring, nbytes, true);
+            write_span.commit(nbytes);
+        }
+        { ReadSpan read_span(guaranteed.get(), 0, nbytes); }
+        EXPECT_EQ(ring->latencies().commit_to_acquire.count, 0);
+
+        ring->set_latency_histograms(true);
+        for (std::size_t i = 1; i < 3; i++) {
+            {
+                WriteSpan write_span(ring, nbytes, true);
+                write_span.commit(nbytes);
+            }
+            ReadSpan read_span(guaranteed.get(), i * nbytes, nbytes);
+        }
+        EXPECT_THROW(ReadSpan(guaranteed.get(), 4 * nbytes, nbytes, std::chrono::milliseconds(1)), RBException);
+
+        auto latencies = ring->latencies();
+        EXPECT_EQ(latencies.commit_to_acquire.count, 2);
+        EXPECT_LE(latencies.commit_to_acquire.p50, latencies.commit_to_acquire.p99);
+        EXPECT_LE(latencies.commit_to_acquire.p99, latencies.commit_to_acquire.max);
+        EXPECT_EQ(latencies.acquire_wait.count, 1);
+        EXPECT_GE(latencies.acquire_wait.max, std::chrono::milliseconds(1));
+        EXPECT_EQ(latencies.reserve_wait.count, 0);
+        EXPECT_EQ(latencies.commit_wait.count, 0);
+
+        // disabling keeps the recorded values
+        ring->set_latency_histograms(false);
+        {
+            WriteSpan write_span(ring, nbytes, true);
+            write_span.commit(nbytes);
+        }
+        { ReadSpan read_span(guaranteed.get(), 3 * nbytes, nbytes); }
+        EXPECT_EQ(ring->latencies().commit_to_acquire.count, 2);
+    }
+    ring->end_writing();
+}
+
+TEST(RingbufferTestSuite, LatencyHistogramBuckets) {
+    using namespace ringbuffer::state;
+
+    for (std::uint64_t value : {0ull, 1ull, 7ull, 8ull, 9ull, 1000ull, 123456789ull, ~0ull}) {
+        int bucket = LatencyHistogram::bucket_of(value);
+        EXPECT_GE(LatencyHistogram::bucket_upper(bucket), value);
+        if (bucket > 0) {
+            EXPECT_LT(LatencyHistogram::bucket_upper(bucket - 1), value);
+        }
+        EXPECT_LT(bucket, LatencyHistogram::BUCKETS);
+    }
+
+    LatencyHistogram histogram;
+    for (std::uint64_t i = 1; i <= 1000; i++) {
+        histogram.record(i * 1000);
+    }
+    auto summary = histogram.summary();
+    EXPECT_EQ(summary.count, 1000);
+    EXPECT_EQ(summary.max, std::chrono::nanoseconds(1000000));
+    // values are known within 12.5%
+    EXPECT_NEAR(double(summary.p50.count()), 500000., 500000. / 8);
+    EXPECT_NEAR(double(summary.p99.count()), 990000., 990000. / 8);
+    EXPECT_LE(summary.p999, summary.max);
+}
+
+TEST(RingbufferTestSuite, MemcpyNonTemporal) {
+    using namespace ringbuffer;
+
+    // odd offsets and widths exercise the unaligned head and tail of every row,
+    //   equal strides and widths the collapsed single copy
+    std::size_t width = RINGBUFFER_NONTEMPORAL_THRESHOLD / 3 + 77;
+    for (std::size_t stride : {width, width + 129}) {
+        std::size_t height = 4;
+        std::vector<uint8_t> src(stride * height + 3), dst(stride * height + 5, 0);
+        for (std::size_t i = 0; i < src.size(); i++) {
+            src[i] = uint8_t(i * 13 + 1);
+        }
+        ASSERT_EQ(memory::memcpy2DNonTemporal(dst.data() + 5, stride, src.data() + 3, stride, width, height),
+                  RBStatus::STATUS_SUCCESS);
+        EXPECT_EQ(dst[4], 0);
+        for (std::size_t r = 0; r < height; r++) {
+            ASSERT_EQ(std::memcmp(dst.data() + 5 + r * stride, src.data() + 3 + r * stride, width), 0);
+        }
+        if (stride != width) {
+            EXPECT_EQ(dst[5 + width], 0);
+        }
+        // parallel streaming copy
+        std::fill(dst.begin(), dst.end(), 0);
+        ASSERT_EQ(memory::memcpy2DParallel(dst.data() + 5, stride, src.data() + 3, stride, width, height, 3, nullptr, true),
+                  RBStatus::STATUS_SUCCESS);
+        for (std::size_t r = 0; r < height; r++) {
+            ASSERT_EQ(std::memcmp(dst.data() + 5 + r * stride, src.data() + 3 + r * stride, width), 0);
+        }
+    }
+}
+
+TEST(RingbufferTestSuite, MemcpyCopyThreads) {
+    using namespace ringbuffer;
+
+    int cores[] = {0, -1, 0};
+
+    // rows split across threads, columns split across threads, and a single contiguous block
+    std::size_t width = RINGBUFFER_PARALLEL_COPY_THRESHOLD / 2 + 33;
+    for (std::size_t height : {std::size_t(7), std::size_t(2)}) {
+        for (std::size_t stride : {width + 64, width}) {
+            std::vector<uint8_t> src(stride * height), dst(stride * height + 1, 0);
+            for (std::size_t i = 0; i < src.size(); i++) {
+                src[i] = uint8_t(i * 5 + 3);
+            }
+            ASSERT_EQ(memory::memcpy2DParallel(dst.data(), stride, src.data(), stride, width, height, 3, cores),
+                      RBStatus::STATUS_SUCCESS);
+            for (std::size_t r = 0; r < height; r++) {
+                ASSERT_EQ(std::memcmp(dst.data() + r * stride, src.data() + r * stride, width), 0);
+            }
+            EXPECT_EQ(dst[stride * height], 0);
+
+            ASSERT_EQ(memory::memset2DParallel(dst.data(), stride, 0xab, width, height, 3, cores),
+                      RBStatus::STATUS_SUCCESS);
+            for (std::size_t r = 0; r < height; r++) {
+                ASSERT_EQ(dst[r * stride], 0xab);
+                ASSERT_EQ(dst[r * stride + width - 1], 0xab);
+                if (stride != width) {
+                    ASSERT_EQ(dst[r * stride + width], 0);
+                }
+            }
+        }
+    }
+
+    // concurrent callers on the same cores do all parts themselves while the pool is busy
+    {
+        std::size_t nbytes = RINGBUFFER_PARALLEL_COPY_THRESHOLD;
+        std::vector<uint8_t> src(nbytes, 7);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&]() {
+                std::vector<uint8_t> dst(nbytes, 0);
+                for (int i = 0; i < 20; i++) {
+                    EXPECT_EQ(memory::memcpy2DParallel(dst.data(), nbytes, src.data(), nbytes, nbytes, 1, 3, cores),
+                              RBStatus::STATUS_SUCCESS);
+                }
+                EXPECT_EQ(dst[nbytes - 1], 7);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // small copies, sets and prefaults stay on the calling thread, no pool is started for them
+    {
+#if defined __linux__ && __linux__
+        auto nthreads = []() {
+            std::ifstream status("/proc/self/status");
+            std::string line;
+            while (std::getline(status, line)) {
+                if (line.compare(0, 8, "Threads:") == 0) {
+                    return std::stoi(line.substr(8));
+                }
+            }
+            return -1;
+        };
+        int before = nthreads();
+#endif
+        // a core list no other test uses, so its pool does not exist yet
+        int small_cores[] = {-1, 0, -1, 0, -1};
+        std::size_t swidth = 3 * memory::getPageSize() + 17, sheight = 5, sstride = swidth + 64;
+        std::vector<uint8_t> src(sstride * sheight), dst(sstride * sheight, 0);
+        for (std::size_t i = 0; i < src.size(); i++) {
+            src[i] = uint8_t(i * 3 + 1);
+        }
+        for (bool nontemporal : {false, true}) {
+            std::fill(dst.begin(), dst.end(), 0);
+            ASSERT_EQ(memory::memcpy2DParallel(dst.data(), sstride, src.data(), sstride, swidth, sheight,
+                                               5, small_cores, nontemporal),
+                      RBStatus::STATUS_SUCCESS);
+            for (std::size_t r = 0; r < sheight; r++) {
+                ASSERT_EQ(std::memcmp(dst.data() + r * sstride, src.data() + r * sstride, swidth), 0);
+                ASSERT_EQ(dst[r * sstride + swidth], 0);
+            }
+        }
+        ASSERT_EQ(memory::memset2DParallel(dst.data(), sstride, 0xcd, swidth, sheight, 5, small_cores),
+                  RBStatus::STATUS_SUCCESS);
+        for (std::size_t r = 0; r < sheight; r++) {
+            ASSERT_EQ(dst[r * sstride], 0xcd);
+            ASSERT_EQ(dst[r * sstride + swidth - 1], 0xcd);
+            ASSERT_NE(dst[r * sstride + swidth], 0xcd);
+        }
+        ASSERT_EQ(memory::prefaultParallel(dst.data(), dst.size(), 5, small_cores), RBStatus::STATUS_SUCCESS);
+#if defined __linux__ && __linux__
+        EXPECT_EQ(nthreads(), before);
+        // the same core list starts its pool once a copy is large enough
+        std::size_t nbytes = RINGBUFFER_PARALLEL_COPY_THRESHOLD;
+        std::vector<uint8_t> large_src(nbytes, 9), large_dst(nbytes, 0);
+        ASSERT_EQ(memory::memcpy2DParallel(large_dst.data(), nbytes, large_src.data(), nbytes, nbytes, 1, 5, small_cores),
+                  RBStatus::STATUS_SUCCESS);
+        EXPECT_EQ(large_dst[nbytes - 1], 9);
+        EXPECT_EQ(nthreads(), before + 4);
+#endif
+    }
+}
+
+TEST(RingbufferTestSuite, RingClassParallelResize) {
+    using namespace ringbuffer;
+
+    setDebugEnabled(true);
+
+    // rows split across threads, and columns split across threads for fewer rows
+    for (std::size_t height : {std::size_t(13), std::size_t(2)}) {
+        std::size_t width = RINGBUFFER_PARALLEL_COPY_THRESHOLD / 2 + 17;
+        std::size_t src_stride = width + 64, dst_stride = width + 128;
+        std::vector<uint8_t> src(src_stride * height), dst(dst_stride * height, 0);
+        for (std::size_t i = 0; i < src.size(); i++) {
+            src[i] = uint8_t(i * 7);
+        }
+        int cores[] = {0, -1, 0, -1};
+        ASSERT_EQ(memory::memcpy2DParallel(dst.data(), dst_stride, src.data(), src_stride, width, height, 4, cores),
+                  RBStatus::STATUS_SUCCESS);
+        for (std::size_t r = 0; r < height; r++) {
+            ASSERT_EQ(std::memcmp(dst.data() + r * dst_stride, src.data() + r * src_stride, width), 0);
+            ASSERT_EQ(dst[r * dst_stride + width], 0);
+        }
+    }
+
+    auto ring = Ring::create("testring_parallel_resize", RBSpace::SPACE_SYSTEM);
+    ring->set_resize_threads(4, {0});
+    ring->set_prefault(true);
+    EXPECT_EQ(ring->resize_threads(), 4);
+    EXPECT_THROW(ring->set_resize_threads(0), std::exception);
+
+    std::size_t nringlets = 3;
+    std::size_t nvalues = 750;
+    std::size_t nbytes = sizeof(uint32_t) * nvalues;
+    ring->resize(nbytes, 4 * nbytes, nringlets);
+
+    std::size_t nspan = 7; // wraps the 16 kB span, so resize migrates both ends
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, nringlets, 0);
+        auto read_seq = ReadSequence::by_name(ring, "mysequence", false);
+        std::size_t stride = ring->locked_stride();
+        for (std::size_t i = 0; i < nspan; i++) {
+            WriteSpan write_span(ring, nbytes, false);
+            for (std::size_t r = 0; r < nringlets; r++) {
+                auto* values = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(write_span.data()) + r * stride);
+                for (std::size_t j = 0; j < nvalues; j++) {
+                    values[j] = uint32_t(i * nvalues + j + r);
+                }
+            }
+            write_span.commit(nbytes);
+        }
+
+        ring->resize(nbytes, 64 * nbytes, nringlets);
+        stride = ring->locked_stride();
+        for (std::size_t i = nspan - 4; i < nspan; i++) {
+            ReadSpan read_span(&read_seq, i * nbytes, nbytes);
+            ASSERT_EQ(read_span.size(), nbytes);
+            for (std::size_t r = 0; r < nringlets; r++) {
+                auto* values = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(read_span.data()) + r * stride);
+                for (std::size_t j = 0; j < nvalues; j++) {
+                    ASSERT_EQ(values[j], uint32_t(i * nvalues + j + r));
+                }
+            }
+        }
+        write_seq.finish();
+    }
+    ring->end_writing();
+}
+
+TEST(RingbufferTestSuite, RingClassIncrementalResize) {
+    using namespace ringbuffer;
+
+    setDebugEnabled(true);
+
+    auto ring = Ring::create("testring_incremental_resize", RBSpace::SPACE_SYSTEM);
+    ring->set_incremental_resize(true);
+    EXPECT_TRUE(ring->incremental_resize());
+
+    std::size_t nringlets = 2;
+    std::size_t nvalues = 500;
+    std::size_t nbytes = sizeof(uint32_t) * nvalues;
+    ring->resize(nbytes, 4 * nbytes, nringlets);
+    EXPECT_FALSE(ring->resize_pending());
+
+    auto fill = [&](Span& span, std::size_t i) {
+        for (std::size_t r = 0; r < nringlets; r++) {
+            auto* values = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(span.data()) + r * span.stride());
+            for (std::size_t j = 0; j < nvalues; j++) {
+                values[j] = uint32_t(i * nvalues + j + r);
+            }
+        }
+    };
+    auto check = [&](Span& span, std::size_t i) {
+        for (std::size_t r = 0; r < nringlets; r++) {
+            auto* values = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(span.data()) + r * span.stride());
+            for (std::size_t j = 0; j < nvalues; j++) {
+                ASSERT_EQ(values[j], uint32_t(i * nvalues + j + r));
+            }
+        }
+    };
+
+    std::size_t nspan = 6; // wraps the old span
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, nringlets, 0);
+        auto read_seq = ReadSequence::by_name(ring, "mysequence", false);
+        for (std::size_t i = 0; i < nspan - 1; i++) {
+            WriteSpan write_span(ring, nbytes, false);
+            fill(write_span, i);
+        }
+        {
+            // a blocking resize would wait for these spans forever
+            ReadSpan old_read(&read_seq, (nspan - 2) * nbytes, nbytes);
+            auto old_write = std::unique_ptr<WriteSpan>(new WriteSpan(ring, nbytes, false));
+            std::size_t old_stride = ring->locked_stride();
+            ring->resize(nbytes, 64 * nbytes, nringlets);
+            EXPECT_GT(ring->locked_stride(), old_stride);
+            EXPECT_EQ(old_read.stride(), old_stride);
+            EXPECT_EQ(old_write->stride(), old_stride);
+            EXPECT_TRUE(ring->resize_pending());
+            EXPECT_THROW(ring->migrate_to_node(0), std::exception);
+
+            // the old write span is copied to the new buffer when it is committed
+            fill(*old_write, nspan - 1);
+            old_write.reset();
+            {
+                WriteSpan write_span(ring, nbytes, false);
+                EXPECT_EQ(write_span.stride(), ring->locked_stride());
+                fill(write_span, nspan);
+            }
+            check(old_read, nspan - 2);
+            EXPECT_TRUE(ring->resize_pending());
+        }
+        for (std::size_t i = 0; i < 100 && ring->resize_pending(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_FALSE(ring->resize_pending());
+
+        for (std::size_t i = nspan - 4; i <= nspan; i++) {
+            ReadSpan read_span(&read_seq, i * nbytes, nbytes);
+            ASSERT_EQ(read_span.size(), nbytes);
+            check(read_span, i);
+        }
+        write_seq.finish();
+    }
+    ring->end_writing();
+
+    // the pipeline keeps running while the ring grows under it
+    auto ring2 = Ring::create("testring_incremental_resize2", RBSpace::SPACE_SYSTEM);
+    ring2->set_incremental_resize(true);
+    ring2->resize(nbytes, 2 * nbytes, nringlets);
+    std::size_t nwrite = 2000;
+    ring2->begin_writing();
+    {
+        WriteSequence write_seq(ring2, "mysequence", 0, 0, nullptr, nringlets, 0);
+        auto read_seq = ReadSequence::by_name(ring2, "mysequence", true);
+        std::thread writer([&]() {
+            for (std::size_t i = 0; i < nwrite; i++) {
+                WriteSpan write_span(ring2, nbytes, false);
+                fill(write_span, i);
+            }
+            write_seq.finish();
+        });
+        std::thread reader([&]() {
+            for (std::size_t i = 0; i < nwrite; i++) {
+                ReadSpan read_span(&read_seq, i * nbytes, nbytes);
+                ASSERT_EQ(read_span.size(), nbytes);
+                check(read_span, i);
+            }
+        });
+        for (std::size_t k = 2; k <= 6; k++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            ring2->resize(nbytes, (std::size_t(1) << k) * nbytes, nringlets);
+        }
+        writer.join();
+        reader.join();
+    }
+    ring2->end_writing();
+}
+
+TEST(RingbufferTestSuite, RingClassNumaPlacement) {
+    using namespace ringbuffer;
+
+    setDebugEnabled(true);
+
+    auto ring = Ring::create("testring_numa", RBSpace::SPACE_SYSTEM);
+    EXPECT_EQ(ring->numa_policy(), RBNumaPolicy::NUMA_CORE);
+#ifdef RINGBUFFER_WITH_NUMA
+    int nnode = 0;
+    ASSERT_EQ(memory::getNumaNodeCount(&nnode), RBStatus::STATUS_SUCCESS);
+    EXPECT_THROW(ring->set_numa_policy(RBNumaPolicy::NUMA_NODE, {0, 0}), std::exception);
+    EXPECT_THROW(ring->set_numa_policy(RBNumaPolicy::NUMA_NODE, {nnode}), std::exception);
+
+    std::size_t nringlets = 3;
+    std::size_t nbytes = 3000;
+    ring->set_numa_policy(RBNumaPolicy::NUMA_RINGLETS);
+    ring->resize(nbytes, 4 * nbytes, nringlets);
+    std::size_t stride = ring->locked_stride();
+    EXPECT_EQ(stride % memory::getPageSize(), 0);
+    auto nodes = ring->numa_nodes_in_use();
+    ASSERT_EQ(nodes.size(), nringlets);
+    for (std::size_t r = 0; r < nringlets; r++) {
+        EXPECT_EQ(nodes[r], int(r % nnode));
+    }
+
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, nringlets, 0);
+        {
+            WriteSpan write_span(ring, nbytes, false);
+            for (std::size_t r = 0; r < nringlets; r++) {
+                auto* data = static_cast<uint8_t*>(write_span.data()) + r * stride;
+                std::memset(data, int(r), nbytes);
+                int node = -1;
+                ASSERT_EQ(memory::getNumaNodeOfAddress(data, &node), RBStatus::STATUS_SUCCESS);
+                EXPECT_EQ(node, nodes[r]);
+            }
+            write_span.commit(nbytes);
+        }
+
+        // placement is re-applied when the ring grows
+        ring->set_numa_policy(RBNumaPolicy::NUMA_NODE, {nnode - 1});
+        ring->resize(nbytes, 16 * nbytes, nringlets);
+        for (int node : ring->numa_nodes_in_use()) {
+            EXPECT_EQ(node, nnode - 1);
+        }
+        auto read_seq = ReadSequence::by_name(ring, "mysequence", true);
+        {
+            ReadSpan read_span(&read_seq, 0, nbytes);
+            stride = ring->locked_stride();
+            for (std::size_t r = 0; r < nringlets; r++) {
+                EXPECT_EQ(static_cast<const uint8_t*>(read_span.data())[r * stride + nbytes - 1], uint8_t(r));
+            }
+        }
+
+        ring->set_numa_policy(RBNumaPolicy::NUMA_INTERLEAVE);
+        ring->resize(nbytes, 64 * nbytes, nringlets);
+        for (int node : ring->numa_nodes_in_use()) {
+            EXPECT_EQ(node, -1);
+        }
+        write_seq.finish();
+    }
+    ring->end_writing();
+
+    // rings smaller than a page keep their ghost region within the span, and grow
+    //   with the data they hold
+    auto small = Ring::create("testring_numa_small", RBSpace::SPACE_SYSTEM);
+    small->set_numa_policy(RBNumaPolicy::NUMA_RINGLETS);
+    small->resize(512, 1024, 2);
+    EXPECT_EQ(small->locked_contiguous_span(), 512);
+    EXPECT_EQ(small->locked_total_span(), 1024);
+    EXPECT_EQ(small->locked_stride() % memory::getPageSize(), 0);
+    small->begin_writing();
+    {
+        WriteSequence write_seq(small, "mysequence", 0, 0, nullptr, 2, 0);
+        auto read_seq = ReadSequence::by_name(small, "mysequence", false);
+        for (std::size_t i = 0; i < 3; i++) {
+            WriteSpan write_span(small, 512, false);
+            std::memset(write_span.data(), int(i + 1), 512);
+            write_span.commit(512);
+        }
+        small->resize(1024, 2048, 2);
+        EXPECT_EQ(small->locked_contiguous_span(), 1024);
+        for (std::size_t i = 1; i < 3; i++) {
+            ReadSpan read_span(&read_seq, i * 512, 512);
+            ASSERT_EQ(read_span.size(), 512);
+            EXPECT_EQ(static_cast<const uint8_t*>(read_span.data())[511], uint8_t(i + 1));
+        }
+        write_seq.finish();
+    }
+    small->end_writing();
+#else
+    EXPECT_THROW(ring->set_numa_policy(RBNumaPolicy::NUMA_NODE, {0}), std::exception);
+    ring->set_numa_policy(RBNumaPolicy::NUMA_NONE);
+    ring->resize(3000, 12000, 2);
+    EXPECT_EQ(ring->numa_nodes_in_use(), std::vector<int>(2, -1));
+#endif
+}
+
+TEST(RingbufferTestSuite, RingClassNumaMigration) {
+    using namespace ringbuffer;
+
+    setDebugEnabled(true);
+
+    auto ring = Ring::create("testring_migrate", RBSpace::SPACE_SYSTEM);
+    std::size_t nringlets = 2;
+    std::size_t nbytes = 1 << 16;
+    ring->set_numa_policy(RBNumaPolicy::NUMA_NONE);
+    ring->resize(nbytes, 8 * nbytes, nringlets);
+#ifdef RINGBUFFER_WITH_NUMA
+    int nnode = 0;
+    ASSERT_EQ(memory::getNumaNodeCount(&nnode), RBStatus::STATUS_SUCCESS);
+    EXPECT_THROW(ring->migrate_to_node(nnode), std::exception);
+
+    std::size_t stride = ring->locked_stride();
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, nringlets, 0);
+        {
+            WriteSpan write_span(ring, nbytes, false);
+            for (std::size_t r = 0; r < nringlets; r++) {
+                std::memset(static_cast<uint8_t*>(write_span.data()) + r * stride, int(r + 1), nbytes);
+            }
+            write_span.commit(nbytes);
+        }
+
+        // spans stay open while the pages move
+        WriteSpan write_span(ring, nbytes, false);
+        std::size_t ncall = 0, last_done = 0, last_moved = 0, total = 0;
+        std::size_t moved = ring->migrate_to_node(nnode - 1, [&](std::size_t done, std::size_t nbyte, std::size_t nmoved) {
+            EXPECT_GT(done, last_done);
+            EXPECT_GE(nmoved, last_moved);
+            last_done = done;
+            last_moved = nmoved;
+            total = nbyte;
+            ncall++;
+        }, nbytes);
+        EXPECT_EQ(total, stride * nringlets);
+        EXPECT_EQ(last_done, total);
+        EXPECT_EQ(moved, last_moved);
+        EXPECT_LE(moved, total);
+        EXPECT_GE(ncall, std::size_t(8));
+        EXPECT_EQ(ring->numa_policy(), RBNumaPolicy::NUMA_NODE);
+        EXPECT_EQ(ring->numa_nodes_in_use(), std::vector<int>(nringlets, nnode - 1));
+        for (std::size_t r = 0; r < nringlets; r++) {
+            int node = -1;
+            ASSERT_EQ(memory::getNumaNodeOfAddress(static_cast<uint8_t*>(write_span.data()) + r * stride, &node),
+                      RBStatus::STATUS_SUCCESS);
+            EXPECT_EQ(node, nnode - 1);
+        }
+        write_span.commit(0);
+
+        auto read_seq = ReadSequence::by_name(ring, "mysequence", true);
+        {
+            ReadSpan read_span(&read_seq, 0, nbytes);
+            for (std::size_t r = 0; r < nringlets; r++) {
+                EXPECT_EQ(static_cast<const uint8_t*>(read_span.data())[r * stride + nbytes - 1], uint8_t(r + 1));
+            }
+        }
+        write_seq.finish();
+    }
+    ring->end_writing();
+#else
+    EXPECT_THROW(ring->migrate_to_node(0), std::exception);
+#endif
+}
+
+#if defined __linux__ && __linux__
+TEST(RingbufferTestSuite, RingClassPrefault) {
+    using namespace ringbuffer;
+
+    setDebugEnabled(true);
+
+    std::size_t page_size = memory::getPageSize();
+    std::size_t npage = 64;
+    {
+        void* ptr = nullptr;
+        ASSERT_EQ(memory::malloc_(&ptr, npage * page_size, RBSpace::SPACE_SYSTEM), RBStatus::STATUS_SUCCESS);
+        ASSERT_EQ(memory::prefault(ptr, npage * page_size, 0), RBStatus::STATUS_SUCCESS);
+        std::vector<unsigned char> resident(npage + 1);
+        auto* first_page = reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(ptr) & ~(page_size - 1));
+        ASSERT_EQ(::mincore(first_page, npage * page_size, resident.data()), 0);
+        for (std::size_t i = 0; i < npage; i++) {
+            EXPECT_TRUE(resident[i] & 1);
+        }
+        // may exceed RLIMIT_MEMLOCK for unprivileged users
+        if (memory::lockMemory(ptr, npage * page_size) == RBStatus::STATUS_SUCCESS) {
+            EXPECT_EQ(memory::unlockMemory(ptr, npage * page_size), RBStatus::STATUS_SUCCESS);
+        }
+        memory::free_(ptr, RBSpace::SPACE_SYSTEM);
+    }
+
+    auto ring = Ring::create("testring_prefault", RBSpace::SPACE_SYSTEM);
+    ring->set_core(0);
+    ring->set_prefault(true);
+    ring->set_memlock(true);
+    EXPECT_TRUE(ring->prefault());
+    EXPECT_TRUE(ring->memlock());
+
+    std::size_t nbytes = 3000;
+    ring->resize(nbytes, 4 * nbytes, 1);
+    // growing reallocates and prefaults again
+    ring->resize(nbytes, 16 * nbytes, 1);
+
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, 1, 0);
+        auto read_seq = ReadSequence::by_name(ring, "mysequence", true);
+        for (std::size_t i = 0; i < 100; i++) {
+            {
+                WriteSpan write_span(ring, nbytes, false);
+                std::memset(write_span.data(), int(i & 0xff), nbytes);
+                write_span.commit(nbytes);
+            }
+            {
+                ReadSpan read_span(&read_seq, i * nbytes, nbytes);
+                const auto* values = static_cast<const uint8_t*>(read_span.data());
+                ASSERT_EQ(values[0], uint8_t(i & 0xff));
+                ASSERT_EQ(values[nbytes - 1], uint8_t(i & 0xff));
+            }
+        }
+        write_seq.finish();
+    }
+    ring->end_writing();
+}
+
+TEST(RingbufferTestSuite, RingClassShrink) {
+    using namespace ringbuffer;
+
+    setDebugEnabled(true);
+
+    std::size_t nringlets = 2;
+    std::size_t nbytes = 16 * memory::getPageSize();
+    auto write = [&](std::shared_ptr<Ring>& ring, std::size_t i) {
+        WriteSpan write_span(ring, nbytes, false);
+        for (std::size_t r = 0; r < ring->current_nringlet(); r++) {
+            std::memset(static_cast<uint8_t*>(write_span.data()) + r * write_span.stride(), int((i + r) & 0xff), nbytes);
+        }
+        write_span.commit(nbytes);
+    };
+    auto check = [&](ReadSequence& read_seq, std::size_t i) {
+        ReadSpan read_span(&read_seq, i * nbytes, nbytes);
+        ASSERT_EQ(read_span.size(), nbytes);
+        for (std::size_t r = 0; r < read_span.nringlet(); r++) {
+            const auto* values = static_cast<const uint8_t*>(read_span.data()) + r * read_span.stride();
+            ASSERT_EQ(values[0], uint8_t((i + r) & 0xff));
+            ASSERT_EQ(values[nbytes - 1], uint8_t((i + r) & 0xff));
+        }
+    };
+
+    auto ring = Ring::create("testring_shrink", RBSpace::SPACE_SYSTEM);
+    ring->resize(nbytes, 64 * nbytes, nringlets);
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, nringlets, 0);
+        auto read_seq = ReadSequence::by_name(ring, "mysequence", true);
+        std::size_t nspan = 72;
+        for (std::size_t i = 0; i < nspan; i++) {
+            write(ring, i);
+            if (i <= nspan - 4) {
+                check(read_seq, i);
+            }
+        }
+        // the guarantee holds the last 4 spans, so the ring cannot go below that
+        RingReclaim result = ring->shrink(nbytes, 2 * nbytes);
+        EXPECT_EQ(ring->locked_total_span(), 4 * nbytes);
+        EXPECT_EQ(ring->current_nringlet(), nringlets);
+        EXPECT_EQ(result.bytes_dropped, 60 * nbytes);
+        EXPECT_LT(result.resident_after, result.resident_before);
+        EXPECT_EQ(result.resident_after, ring->resident_size());
+        // the newest data survived, and the smaller ring keeps working across its end
+        for (std::size_t i = nspan - 4; i < nspan + 10; i++) {
+            if (i >= nspan) {
+                write(ring, i);
+            }
+            check(read_seq, i);
+        }
+        // nothing to give back
+        result = ring->shrink(nbytes, 4 * nbytes);
+        EXPECT_EQ(result.bytes_dropped, 0u);
+        EXPECT_EQ(ring->locked_total_span(), 4 * nbytes);
+        write_seq.finish();
+    }
+    ring->end_writing();
+
+    for (bool mirrored : {false, true}) {
+        auto ring2 = Ring::create(mirrored ? "testring_reclaim_mirrored" : "testring_reclaim", RBSpace::SPACE_SYSTEM);
+        ring2->set_mirrored(mirrored);
+        ring2->set_prefault(true);
+        ring2->resize(nbytes, 64 * nbytes, nringlets);
+        ring2->begin_writing();
+        {
+            WriteSequence write_seq(ring2, "mysequence", 0, 0, nullptr, nringlets, 0);
+            auto read_seq = ReadSequence::by_name(ring2, "mysequence", false);
+            std::size_t nspan = 32;
+            for (std::size_t i = 0; i < nspan; i++) {
+                write(ring2, i);
+            }
+            // only the free half of the prefaulted buffer goes, the data stays readable
+            std::size_t resident = ring2->resident_size();
+            EXPECT_GE(resident, 2 * nspan * nbytes * nringlets);
+            RingReclaim result = ring2->reclaim_idle();
+            EXPECT_EQ(result.resident_before, resident);
+            EXPECT_EQ(result.bytes_dropped, 0u);
+            EXPECT_GE(result.resident_after, nspan * nbytes * nringlets);
+            EXPECT_LE(result.resident_after, (nspan + 2) * nbytes * nringlets);
+            EXPECT_EQ(ring2->current_tail_offset(), 0u);
+            for (std::size_t i = 0; i < nspan; i++) {
+                check(read_seq, i);
+            }
+
+            // write into the free space again, then let the idle policy give the rest back
+            for (std::size_t i = nspan; i < nspan + 16; i++) {
+                write(ring2, i);
+            }
+            ring2->set_idle_reclaim(std::chrono::milliseconds(10));
+            EXPECT_EQ(ring2->idle_reclaim(), std::chrono::milliseconds(10));
+            for (int wait = 0; wait < 100 && ring2->resident_size() > (nspan + 18) * nbytes * nringlets; wait++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            EXPECT_LE(ring2->resident_size(), (nspan + 18) * nbytes * nringlets);
+            EXPECT_EQ(ring2->current_tail_offset(), 0u);
+            for (std::size_t i = 0; i < nspan + 16; i++) {
+                check(read_seq, i);
+            }
+            ring2->set_idle_reclaim(std::chrono::milliseconds(0));
+            // the given back pages are used again once the ring wraps
+            for (std::size_t i = nspan + 16; i < 5 * nspan; i++) {
+                write(ring2, i);
+                check(read_seq, i);
+            }
+            write_seq.finish();
+        }
+        ring2->end_writing();
+    }
+}
+
+TEST(RingbufferTestSuite, RingClassProcLog) {
+    using namespace ringbuffer;
+
+    // enabled here, so the test also runs with RINGBUFFER_PROCLOG=0
+    bool proclog_enabled = getProcLogEnabled();
+    ASSERT_EQ(setProcLogEnabled(true), RBStatus::STATUS_SUCCESS);
+    proclog::setUpdateInterval(std::chrono::milliseconds(5));
+
+    auto read_entry = [](const std::string& path) {
+        std::ifstream file(path);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    };
+
+    std::string path = proclog::directory() + "/rings/testring_proclog";
+    {
+        auto ring = Ring::create("testring_proclog", RBSpace::SPACE_SYSTEM);
+        std::size_t nbytes = 1024;
+        ring->resize(nbytes, 4 * nbytes, 1);
+        ring->begin_writing();
+        {
+            WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, 1, 0);
+            for (std::size_t i = 0; i < 3; i++) {
+                WriteSpan write_span(ring, nbytes, true);
+                write_span.commit(nbytes);
+            }
+            // the static part is written right away, the counters by the monitor thread
+            std::string expected_head = "head : " + std::to_string(3 * nbytes) + "\n";
+            std::string entry;
+            for (int i = 0; i < 200 && entry.find(expected_head) == std::string::npos; i++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                entry = read_entry(path);
+            }
+            EXPECT_NE(entry.find("name : testring_proclog\n"), std::string::npos);
+            EXPECT_NE(entry.find("span : " + std::to_string(ring->locked_total_span()) + "\n"), std::string::npos);
+            EXPECT_NE(entry.find(expected_head), std::string::npos);
+            EXPECT_NE(entry.find("spans_committed : 3\n"), std::string::npos);
+        }
+        ring->end_writing();
+    }
+    // removed with the ring
+    EXPECT_FALSE(std::ifstream(path).good());
+
+    proclog::setUpdateInterval(std::chrono::milliseconds(RINGBUFFER_PROCLOG_INTERVAL_MS));
+    setProcLogEnabled(proclog_enabled);
+}
+#endif
+
+#ifdef RINGBUFFER_TRACE
+TEST(RingbufferTestSuite, RingClassTrace) {
+    using namespace ringbuffer;
+
+    trace::clear();
+    auto ring = Ring::create("testring_trace", RBSpace::SPACE_SYSTEM);
+    std::size_t nbytes = 1024;
+    ring->resize(nbytes, 4 * nbytes, 1);
+    ring->begin_writing();
+    {
+        WriteSequence write_seq(ring, "mysequence", 0, 0, nullptr, 1, 0);
+        auto read_seq = ReadSequence::by_name_ptr(ring, "mysequence", true);
+        {
+            WriteSpan write_span(ring, nbytes, true);
+            write_span.commit(nbytes);
+        }
+        { ReadSpan read_span(read_seq.get(), 0, nbytes); }
+        std::thread([]() {
+            RB_TRACE_NAME(std::string("worker \"scope\""));
+        }).join();
+    }
+    ring->end_writing();
+
+    std::stringstream json;
+    trace::dump(json);
+    std::string trace = json.str();
+    EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0);
+    for (const char* name : {"resize", "try_reserve_span", "_commit_span", "try_acquire_span", "release_span"}) {
+        EXPECT_NE(trace.find(std::string("Ring::") + name + "("), std::string::npos) << name;
+    }
+    EXPECT_NE(trace.find("\"worker \\\"scope\\\"\""), std::string::npos);
+    EXPECT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_EQ(trace::getDroppedEvents(), 0);
+}
+#endif
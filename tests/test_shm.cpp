@@ -0,0 +1,187 @@
+/* **********************************************************************************
+#                                                                                   #
+# Copyright (c) 2019,                                                               #
+# Research group CAMP                                                               #
+# Technical University of Munich                                                    #
+#                                                                                   #
+# All rights reserved.                                                              #
+# Ulrich Eck - ulrich.eck@tum.de                                                    #
+#                                                                                   #
+# Redistribution and use in source and binary forms, with or without                #
+# modification, are restricted to the following conditions:                         #
+#                                                                                   #
+#  * The software is permitted to be used internally only by the research group     #
+#    CAMP and any associated/collaborating groups and/or individuals.               #
+#  * The software is provided for your internal use only and you may                #
+#    not sell, rent, lease or sublicense the software to any other entity           #
+#    without specific prior written permission.                                     #
+#    You acknowledge that the software in source form remains a confidential        #
+#    trade secret of the research group CAMP and therefore you agree not to         #
+#    attempt to reverse-engineer, decompile, disassemble, or otherwise develop      #
+#    source code for the software or knowingly allow others to do so.               #
+#  * Redistributions of source code must retain the above copyright notice,         #
+#    this list of conditions and the following disclaimer.                          #
+#  * Redistributions in binary form must reproduce the above copyright notice,      #
+#    this list of conditions and the following disclaimer in the documentation      #
+#    and/or other materials provided with the distribution.                         #
+#  * Neither the name of the research group CAMP nor the names of its               #
+#    contributors may be used to endorse or promote products derived from this      #
+#    software without specific prior written permission.                            #
+#                                                                                   #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   #
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     #
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            #
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR   #
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    #
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      #
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND       #
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT        #
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      #
+#                                                                                   #
+*************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include "ringbuffer/ring.h"
+#include "ringbuffer/sequence.h"
+#include "ringbuffer/span.h"
+#include "ringbuffer/detail/guarantee.h"
+#include "ringbuffer/detail/shm.h"
+
+#if defined __linux__ && __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined __linux__ && __linux__
+TEST(RingbufferTestSuite, RingShmCrossProcess) {
+    using namespace ringbuffer;
+
+    ASSERT_TRUE(getShmEnabled());
+
+    struct FrameHeader {
+        uint64_t frame_size{0};
+        uint64_t nframes{0};
+    };
+
+    std::string name = "testring_shm_" + std::to_string(::getpid());
+    std::size_t niter = 2000;
+    std::size_t nvalues = 1000;
+    std::size_t nbytes = sizeof(uint32_t) * nvalues;
+
+    auto ring = Ring::create(name, RBSpace::SPACE_SHM);
+    EXPECT_EQ(ring->space(), RBSpace::SPACE_SHM);
+    EXPECT_TRUE(ring->mirrored());
+    ring->resize(nbytes, 4 * nbytes, 1);
+
+    FrameHeader header;
+    header.frame_size = nbytes;
+    header.nframes = niter;
+    uint64_t footer = 42;
+
+    ring->begin_writing();
+    WriteSequence write_seq(ring, "frames", 0, sizeof(header), &header, 1);
+
+    int ready[2];
+    ASSERT_EQ(::pipe(ready), 0);
+    pid_t pid = ::fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        // reader process
+        bool ok = true;
+        try {
+            auto remote = Ring::attach(name);
+            ok = ok && remote->attached() && remote->locked_total_span() == ring->locked_total_span();
+            auto read_seq = ReadSequence::by_name(remote, "frames", true);
+            char c = 1;
+            ok = ok && ::write(ready[1], &c, 1) == 1;
+            auto* remote_header = reinterpret_cast<const FrameHeader*>(read_seq.header());
+            ok = ok && read_seq.header_size() == sizeof(FrameHeader) && remote_header->nframes == niter;
+            for (std::size_t i = 0; i < niter && ok; i++) {
+                ReadSpan read_span(&read_seq, i * nbytes, nbytes);
+                ok = ok && read_span.size() == nbytes;
+                auto* values = reinterpret_cast<const uint32_t*>(read_span.data());
+                for (std::size_t j = 0; j < nvalues && ok; j++) {
+                    ok = values[j] == uint32_t(i * nvalues + j);
+                }
+            }
+            // the writer ends the stream after the last frame
+            try {
+                ReadSpan read_span(&read_seq, niter * nbytes, nbytes);
+                ok = false;
+            } catch (RBException&) {
+            }
+            ok = ok && read_seq.is_finished() && read_seq.footer_size() == sizeof(footer) &&
+                 *reinterpret_cast<const uint64_t*>(read_seq.footer()) == footer;
+        } catch (std::exception&) {
+            ok = false;
+        }
+        ::_exit(ok ? 0 : 1);
+    }
+
+    // writer process: wait until the reader holds its guarantee
+    char c = 0;
+    ASSERT_EQ(::read(ready[0], &c, 1), 1);
+    for (std::size_t i = 0; i < niter; i++) {
+        WriteSpan write_span(ring, nbytes, false);
+        auto* values = reinterpret_cast<uint32_t*>(write_span.data());
+        for (std::size_t j = 0; j < nvalues; j++) {
+            values[j] = uint32_t(i * nvalues + j);
+        }
+        write_span.commit(nbytes);
+    }
+    write_seq.finish(sizeof(footer), &footer);
+    ring->end_writing();
+
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    ::close(ready[0]);
+    ::close(ready[1]);
+}
+#endif
+
+#if defined __linux__ && __linux__
+TEST(RingbufferTestSuite, RingShmNameInUse) {
+    using namespace ringbuffer;
+
+    ASSERT_TRUE(getShmEnabled());
+
+    std::size_t nbytes = 4096;
+
+    // a live writer keeps its name, readers still attach to its ring
+    std::string name = "testring_shm_inuse_" + std::to_string(::getpid());
+    auto ring = Ring::create(name, RBSpace::SPACE_SHM);
+    ring->resize(nbytes, 4 * nbytes, 1);
+    {
+        auto other = Ring::create(name, RBSpace::SPACE_SHM);
+        try {
+            other->resize(nbytes, 8 * nbytes, 1);
+            ADD_FAILURE() << "segment of a live writer was replaced";
+        } catch (RBException& e) {
+            EXPECT_EQ(e.status(), RBStatus::STATUS_RING_NOT_AVAILABLE);
+        }
+    }
+    auto remote = Ring::attach(name);
+    EXPECT_EQ(remote->locked_total_span(), ring->locked_total_span());
+
+    // the segment of a writer that died without cleaning up is taken over
+    std::string stale_name = "testring_shm_stale_" + std::to_string(::getpid());
+    pid_t pid = ::fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        shm::Segment segment;
+        RBStatus status = shm::create(stale_name, 4 * nbytes, nbytes, 1, &segment);
+        ::_exit(status == RBStatus::STATUS_SUCCESS ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    auto stale = Ring::create(stale_name, RBSpace::SPACE_SHM);
+    stale->resize(nbytes, 8 * nbytes, 1);
+    EXPECT_EQ(stale->locked_total_span(), 8 * nbytes);
+}
+#endif